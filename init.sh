@@ -7,7 +7,6 @@ rm -rf al_ext
 # get submodules
 git submodule update --init --recursive
 
-# generate .h files for all NAM models
-find assets -name "*.nam" | while read -r file; do
-  python3 RTNeural/modules/rt-nam/nam_to_header.py "$file" "${file%.nam}.h"
-done
\ No newline at end of file
+# NAM models are loaded at runtime, see src/audio/namLoader.hpp.
+# To compile a model in instead, generate a header with:
+#   python3 RTNeural/modules/rt-nam/nam_to_header.py model.nam model.h
\ No newline at end of file
@@ -0,0 +1,208 @@
+#ifndef EOYS_AGENT_RENDERER
+#define EOYS_AGENT_RENDERER
+
+// std includes
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// al includes
+#include "al/graphics/al_BufferObject.hpp"
+#include "al/graphics/al_Font.hpp"
+#include "al/graphics/al_Graphics.hpp"
+#include "al/graphics/al_OpenGL.hpp"
+#include "al/graphics/al_Shader.hpp"
+#include "al/graphics/al_Shapes.hpp"
+#include "al/graphics/al_VAOMesh.hpp"
+
+/**
+ * @brief Process-wide glyph atlas cache. Every caller asking for the same font
+ * file at the same size gets the same al::Font, so the atlas is rasterized and
+ * uploaded once no matter how many agents use it. Call from the graphics thread.
+ */
+inline al::Font* sharedFont(const std::string& path, int fontSize = 64, int bitmapSize = 2048) {
+  static std::map<std::pair<std::string, int>, std::unique_ptr<al::Font>> cache;
+  auto key = std::make_pair(path, fontSize);
+  auto it = cache.find(key);
+  if (it != cache.end()) { return it->second.get(); }
+
+  std::unique_ptr<al::Font> font(new al::Font());
+  if (!font->load(path.c_str(), fontSize, bitmapSize)) {
+    std::cerr << "sharedFont Error: Cannot load " << path << std::endl;
+    return nullptr;
+  }
+  return (cache[key] = std::move(font)).get();
+}
+
+static const char* kMarkerVert = R"(
+#version 330
+uniform mat4 al_ModelViewMatrix;
+uniform mat4 al_ProjectionMatrix;
+layout (location = 0) in vec3 position;
+layout (location = 5) in vec4 instanceOffset; // xyz position, w scale
+layout (location = 6) in vec4 instanceColor;
+out vec4 color;
+void main() {
+  color = instanceColor;
+  vec3 world = position * instanceOffset.w + instanceOffset.xyz;
+  gl_Position = al_ProjectionMatrix * al_ModelViewMatrix * vec4(world, 1.0);
+}
+)";
+
+static const char* kMarkerFrag = R"(
+#version 330
+in vec4 color;
+out vec4 fragColor;
+void main() {
+  fragColor = color;
+}
+)";
+
+// labels are one batched mesh: position is the agent, normal.xy the glyph corner
+static const char* kLabelVert = R"(
+#version 330
+uniform mat4 al_ModelViewMatrix;
+uniform mat4 al_ProjectionMatrix;
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec4 vertexColor;
+layout (location = 2) in vec2 texcoord;
+layout (location = 3) in vec3 normal;
+out vec2 uv;
+out vec4 color;
+void main() {
+  uv = texcoord;
+  color = vertexColor;
+  vec4 anchor = al_ModelViewMatrix * vec4(position, 1.0);
+  gl_Position = al_ProjectionMatrix * (anchor + vec4(normal.xy, 0.0, 0.0)); // face the camera
+}
+)";
+
+static const char* kLabelFrag = R"(
+#version 330
+uniform sampler2D tex0;
+in vec2 uv;
+in vec4 color;
+out vec4 fragColor;
+void main() {
+  vec4 glyph = texture(tex0, uv);
+  float coverage = glyph.a < 1.0 ? glyph.a : glyph.r; // single channel or RGBA atlas
+  fragColor = vec4(color.rgb, color.a * coverage);
+}
+)";
+
+/**
+ * @brief Draws the marker spheres and name labels of a set of agents:
+ * all markers in one instanced draw, all labels in one draw from a shared atlas.
+ * Works with anything that has `pose()`, `color` and `name()`, e.g. SpatialAgent.
+ */
+class AgentRenderer {
+public:
+  float markerRadius = 0.3f;
+  float labelHeight = 0.2f;
+
+  template <class TAgent>
+  void draw(al::Graphics& g, const std::vector<TAgent*>& agents) {
+    if (agents.empty()) { return; }
+    if (!mCreated) { create(); }
+
+    // markers, one instance per agent
+    mInstances.clear();
+    for (auto* agent : agents) {
+      al::Vec3f pos = agent->pose().pos();
+      al::Color color(agent->color);
+      mInstances.insert(mInstances.end(), { pos.x, pos.y, pos.z, 1.f, color.r, color.g, color.b, color.a });
+    }
+    mInstanceBuffer.bind();
+    mInstanceBuffer.data(mInstances.size() * sizeof(float), mInstances.data());
+    g.shader(mMarkerShader);
+    g.update(); // push matrices to the shader
+    mMarker.vao().bind();
+    glDrawArraysInstanced(GL_LINE_STRIP, 0, GLsizei(mMarker.vertices().size()), GLsizei(agents.size()));
+    mMarker.vao().unbind();
+
+    // labels, rebuilt only when an agent moved or was renamed
+    if (!mFont) { return; }
+    if (labelsChanged(agents)) { buildLabels(agents); }
+    g.shader(mLabelShader);
+    mLabelShader.uniform("tex0", 0);
+    g.blending(true);
+    g.blendTrans();
+    mFont->tex.bind(0);
+    g.draw(mLabelMesh);
+    mFont->tex.unbind(0);
+    g.blending(false);
+  }
+
+private:
+  bool mCreated = false;
+  al::VAOMesh mMarker;
+  al::BufferObject mInstanceBuffer;
+  std::vector<float> mInstances;
+  al::ShaderProgram mMarkerShader;
+
+  al::Font* mFont = nullptr;
+  al::VAOMesh mLabelMesh;
+  al::ShaderProgram mLabelShader;
+  std::vector<std::pair<std::string, al::Vec3f>> mLabelState; // what mLabelMesh was built from
+
+  void create() {
+    mCreated = true;
+
+    al::addSphere(mMarker, markerRadius);
+    mMarker.primitive(al::Mesh::LINE_STRIP);
+    mMarker.update();
+    mMarkerShader.compile(kMarkerVert, kMarkerFrag);
+
+    mInstanceBuffer.bufferType(GL_ARRAY_BUFFER);
+    mInstanceBuffer.usage(GL_DYNAMIC_DRAW);
+    mInstanceBuffer.create();
+    mMarker.vao().bind();
+    mMarker.vao().enableAttrib(5);
+    mMarker.vao().attribPointer(5, mInstanceBuffer, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float), 0);
+    mMarker.vao().enableAttrib(6);
+    mMarker.vao().attribPointer(6, mInstanceBuffer, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float), 4 * sizeof(float));
+    glVertexAttribDivisor(5, 1);
+    glVertexAttribDivisor(6, 1);
+    mMarker.vao().unbind();
+
+    mFont = sharedFont(al::Font::defaultFont());
+    mLabelShader.compile(kLabelVert, kLabelFrag);
+  }
+
+  template <class TAgent>
+  bool labelsChanged(const std::vector<TAgent*>& agents) const {
+    if (mLabelState.size() != agents.size()) { return true; }
+    for (size_t i = 0; i < agents.size(); i++) {
+      if (mLabelState[i].first != agents[i]->name() ||
+          mLabelState[i].second != al::Vec3f(agents[i]->pose().pos())) { return true; }
+    }
+    return false;
+  }
+
+  template <class TAgent>
+  void buildLabels(const std::vector<TAgent*>& agents) {
+    mLabelState.clear();
+    mLabelMesh.reset();
+    mLabelMesh.primitive(al::Mesh::TRIANGLES);
+    al::Mesh glyphs;
+    for (auto* agent : agents) {
+      al::Vec3f pos = agent->pose().pos();
+      mLabelState.emplace_back(agent->name(), pos);
+
+      glyphs.reset();
+      mFont->write(glyphs, agent->name().c_str(), labelHeight);
+      for (size_t v = 0; v < glyphs.vertices().size(); v++) {
+        mLabelMesh.vertex(pos);
+        mLabelMesh.color(al::Color(agent->color));
+        mLabelMesh.texCoord(glyphs.texCoord2s()[v]);
+        mLabelMesh.normal(glyphs.vertices()[v].x, glyphs.vertices()[v].y, 0.f);
+      }
+    }
+    mLabelMesh.update();
+  }
+};
+
+#endif // EOYS_AGENT_RENDERER
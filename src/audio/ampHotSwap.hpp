@@ -0,0 +1,169 @@
+#ifndef EOYS_AMP_HOT_SWAP
+#define EOYS_AMP_HOT_SWAP
+
+// std includes
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// eoys includes
+#include "namDispatch.hpp"
+
+namespace giml {
+  /**
+   * @brief Amp slot whose NAM model can be replaced while audio is running.
+   *
+   * `loadAsync()` hands a path to one long-lived loader thread, which parses,
+   * prepares and prewarms the new model and hands it over through an atomic
+   * pointer. The audio thread picks
+   * it up at the next sample, runs both models through a short equal-power
+   * crossfade, then hands the old model back for the loader to free. Neither
+   * the audio thread nor the caller of loadAsync() ever waits on a load.
+   */
+  class HotSwapAmp : public Effect<float> {
+  private:
+    std::unique_ptr<Effect<float>> mCurrent; // owned by the audio thread once running
+    Effect<float>* mNext = nullptr; // fading in, owned by the audio thread
+    std::atomic<Effect<float>*> mPending { nullptr }; // loader -> audio thread
+    std::atomic<Effect<float>*> mRetired { nullptr }; // audio thread -> loader
+
+    std::vector<float> mFadeIn; // equal-power gains, fade out is the same table reversed
+    int mFadePos = 0;
+
+    std::thread mLoader;
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    std::string mRequest; // next path to load, guarded by mMutex
+    bool mHasRequest = false;
+    bool mStopping = false;
+
+  public:
+    /**
+     * @param fadeSamples Crossfade length in samples (1024 ~ 23ms at 44.1kHz)
+     */
+    HotSwapAmp(int fadeSamples = 1024) {
+      this->enabled = false;
+      mFadeIn.resize(fadeSamples);
+      for (int i = 0; i < fadeSamples; i++) {
+        mFadeIn[i] = std::sin(float(M_PI_2) * (i + 0.5f) / fadeSamples);
+      }
+    }
+
+    ~HotSwapAmp() {
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+      }
+      mWake.notify_all();
+      if (mLoader.joinable()) { mLoader.join(); }
+      delete mPending.exchange(nullptr);
+      delete mRetired.exchange(nullptr);
+      delete mNext;
+    }
+
+    HotSwapAmp(const HotSwapAmp&) = delete;
+    HotSwapAmp& operator=(const HotSwapAmp&) = delete;
+
+    /**
+     * @brief Installs a model immediately. Only call while audio is not running,
+     * e.g. from onInit; use loadAsync() once the strip is processing.
+     */
+    void setModel(std::unique_ptr<Effect<float>> model) {
+      model->toggle(true);
+      mCurrent = std::move(model);
+    }
+
+    /**
+     * @brief Loads a `.nam` file on the loader thread and crossfades to it.
+     * Returns at once. Requests made while one is loading collapse to the
+     * newest; a model that was loaded but never picked up is simply replaced.
+     */
+    void loadAsync(const std::string& namPath) {
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRequest = namPath;
+        mHasRequest = true;
+        if (!mLoader.joinable()) { mLoader = std::thread([this]() { run(); }); }
+      }
+      mWake.notify_one();
+    }
+
+    bool swapping() const {
+      return mNext != nullptr;
+    }
+
+    float processSample(const float& input) override {
+      // pick up a new model, once the previous old one has been collected
+      if (!mNext && !mRetired.load(std::memory_order_relaxed) &&
+          mPending.load(std::memory_order_relaxed)) {
+        mNext = mPending.exchange(nullptr, std::memory_order_acq_rel);
+        mFadePos = 0;
+        if (mNext && !mCurrent) { // nothing to fade from
+          mCurrent.reset(mNext);
+          mNext = nullptr;
+        }
+      }
+
+      if (!mCurrent) { return input; }
+      if (!this->enabled) {
+        if (mNext) { finishSwap(); } // bypassed, nothing to fade
+        return input;
+      }
+      if (!mNext) { return mCurrent->processSample(input); }
+
+      // equal-power crossfade, both models keep running
+      const int len = int(mFadeIn.size());
+      float out = mFadeIn[len - 1 - mFadePos] * mCurrent->processSample(input) +
+                  mFadeIn[mFadePos] * mNext->processSample(input);
+      if (++mFadePos >= len) { finishSwap(); }
+      return out;
+    }
+
+  private:
+    // loader thread: loads requests and frees models the audio thread is done with
+    void run() {
+      std::unique_lock<std::mutex> lock(mMutex);
+      while (!mStopping) {
+        mWake.wait_for(lock, std::chrono::milliseconds(20), [this]() { return mStopping || mHasRequest; });
+        collect();
+        if (mStopping || !mHasRequest) { continue; }
+        const std::string namPath = mRequest;
+        mHasRequest = false;
+        lock.unlock();
+
+        NamModel model;
+        std::unique_ptr<Effect<float>> amp;
+        if (loadNamModel(namPath, model)) { amp = makeNamEffect(model, *activeNamBackend().table); } // load, prepare, prewarm
+        if (amp) {
+          amp->toggle(true);
+          // publish; if the audio thread never took the last one, it's still ours
+          delete mPending.exchange(amp.release(), std::memory_order_acq_rel);
+        } else {
+          std::cerr << "HotSwapAmp Error: Could not load " << namPath << ", keeping the current model" << std::endl;
+        }
+        lock.lock();
+      }
+      collect();
+    }
+
+    // frees a model the audio thread has finished with, if any
+    void collect() {
+      delete mRetired.exchange(nullptr, std::memory_order_acq_rel);
+    }
+
+    void finishSwap() {
+      mRetired.store(mCurrent.release(), std::memory_order_release);
+      mCurrent.reset(mNext);
+      mNext = nullptr;
+    }
+  };
+} // namespace giml
+
+#endif // EOYS_AMP_HOT_SWAP
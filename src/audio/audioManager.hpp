@@ -1,11 +1,20 @@
 #ifndef EOYS_AUDIO_MANAGER
 #define EOYS_AUDIO_MANAGER
 
+#include <cstdint>
+#include <iostream>
+#include <typeindex>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "al/scene/al_DistributedScene.hpp"
 #include "al/sound/al_Spatializer.hpp"
 #include "al/sound/al_Ambisonics.hpp"
 #include "spatialAgent.hpp"
 #include "channelStrip.hpp"
+#include "agentRenderer.hpp"
+#include "../graphics/analysisBus.hpp"
+#include "../graphics/drumTriggers.hpp"
 
 class DistributedSceneWithInput : public al::DistributedScene {
 public:
@@ -30,12 +39,24 @@ class AudioManager {
 private:
   DistributedSceneWithInput mDistributedScene;
   al::PickableManager mPickableManager;
+  AgentRenderer mAgentRenderer;
+  std::vector<TSynthVoice*> mDrawnAgents; // scratch for draw()
   std::vector<al::PresetHandler*> mPresetHandlers;
   std::vector<TSynthVoice*> mAgents;
   bool pickablesUpdatingParameters = false;
   al::Pose fixedListenerPose;
   int sampleRate = -1;
 
+  // per voice type, see prewarmVoices()
+  struct VoicePool {
+    std::string name;
+    int depth = 0; // requested at startup
+    uint64_t hits = 0; // voice came from the pool
+    uint64_t misses = 0; // voice had to be constructed at cue time
+    std::unordered_set<const al::SynthVoice*> built; // every voice of this type that exists
+  };
+  std::unordered_map<std::type_index, VoicePool> mVoicePools;
+
 public:
 
   AudioManager() {
@@ -47,6 +68,16 @@ public:
     return &mDistributedScene;
   }
 
+  // features for each input channel, computed once per hop for all voices
+  AnalysisBus& analysis() {
+    return analysisBus();
+  }
+
+  // hits on the drum mics, detected in processAudio()
+  DrumTriggerBus& drums() {
+    return drumTriggers();
+  }
+
   std::vector<TSynthVoice*>* agents() {
     return &mAgents;
   }
@@ -55,12 +86,62 @@ public:
     fixedListenerPose = pose;
   }
 
+  /**
+   * @brief Constructs `depth` voices of a registered type up front and parks
+   * them in the scene's free list, so getVoice() at cue time reuses one
+   * instead of building it on the render thread. Call from onInit() on every
+   * node: replicas take voices from the same free list when a cue arrives.
+   * Only call before audio starts: it reads the free list without the
+   * scene's lock, to learn which voices the pool built.
+   */
+  template <class TVoice>
+  void prewarmVoices(int depth) {
+    VoicePool& pool = mVoicePools[std::type_index(typeid(TVoice))];
+    pool.name = al::demangle(typeid(TVoice).name());
+    pool.depth += depth;
+    mDistributedScene.template allocatePolyphony<TVoice>(depth);
+    for (auto* voice = mDistributedScene.getFreeVoices(); voice; voice = voice->next) {
+      if (typeid(*voice) == typeid(TVoice)) { pool.built.insert(voice); }
+    }
+  }
+
+  /**
+   * @brief Same as `scene()->getVoice<TVoice>()`, but counts pool hits and
+   * misses for prewarmed types. A miss (a voice the pool has never seen, so
+   * the scene just built it) means the pool was too shallow.
+   */
+  template <class TVoice>
+  TVoice* getVoice() {
+    TVoice* voice = mDistributedScene.template getVoice<TVoice>();
+    auto it = mVoicePools.find(std::type_index(typeid(TVoice)));
+    if (voice && it != mVoicePools.end()) {
+      VoicePool& pool = it->second;
+      if (pool.built.insert(voice).second) {
+        pool.misses++;
+        std::cerr << "AudioManager Warning: Voice pool for " << pool.name
+                  << " was empty, constructed one at cue time" << std::endl;
+      } else {
+        pool.hits++;
+      }
+    }
+    return voice;
+  }
+
+  void reportVoicePools() {
+    std::cout << "Voice pools:" << std::endl;
+    for (auto& entry : mVoicePools) {
+      const VoicePool& pool = entry.second;
+      std::cout << "  " << pool.name << ": depth " << pool.depth
+                << ", hits " << pool.hits << ", misses " << pool.misses << std::endl;
+    }
+  }
+
   void addAgent(const char name[], bool isPrimary = true) {
     // add agent
     auto* newAgent = mDistributedScene.getVoice<TSynthVoice>();
     newAgent->setName(name); 
     if  (!isPrimary) {
-      newAgent->markAsReplica(); // mark as replica if not primary
+      newAgent->markAsReplica(); // mark as replica if not primary, replicas build no DSP
     }
     mAgents.push_back(newAgent);
 
@@ -102,6 +183,8 @@ public:
     // Prepare the mDistributedScene for audio rendering
     mDistributedScene.prepare(audioIO);
     sampleRate = int(audioIO.framesPerSecond());
+    analysisBus().allocate(audioIO.channelsIn(), float(audioIO.framesPerSecond()));
+    drumTriggers().setSampleRate(float(audioIO.framesPerSecond()));
     for (auto agent : mAgents) {
       mDistributedScene.triggerOn(agent);
     }
@@ -176,11 +259,20 @@ public:
   void processAudio(al::AudioIOData& io) {
     io.zeroOut(); // clear outputs... should be done?
     mDistributedScene.listenerPose(fixedListenerPose); // seg faults
+    drumTriggers().process(io); // cheap, so hits go out this block
+    analysisBus().process(io); // copies the inputs out for the analysis thread
     mDistributedScene.render(io);
   }
 
   void draw(al::Graphics& g) {
     mDistributedScene.render(g);
+
+    // markers and labels for every agent in one go; replicas stay hidden
+    mDrawnAgents.clear();
+    for (auto agent : mAgents) {
+      if (!agent->isReplica()) { mDrawnAgents.push_back(agent); }
+    }
+    mAgentRenderer.draw(g, mDrawnAgents);
   }
 
   void drawGUI(al::Graphics& g) {
@@ -0,0 +1,127 @@
+#ifndef EOYS_CACHED_DBAP
+#define EOYS_CACHED_DBAP
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// al includes
+#include "al/io/al_AudioIOData.hpp"
+#include "al/sound/al_Spatializer.hpp"
+
+// eoys includes
+#include "spatialGainCache.hpp"
+
+/**
+ * @brief Distance-based amplitude panning with the same gain law as `al::Dbap`,
+ * but each source's speaker gains are cached and only recomputed when it moves.
+ *
+ * A source that hasn't moved renders as a plain gain multiply-accumulate per
+ * speaker. A source that moved ramps linearly from its old to its new gains
+ * across the block, so moves never click. See SpatialGainCache for how sources
+ * are told apart.
+ */
+class CachedDbap : public al::Spatializer {
+public:
+  static constexpr int kMaxSources = 64;
+
+  CachedDbap(const al::Speakers& sl, float focus = 1.f) : al::Spatializer(sl), mFocus(focus) {
+    mNumSpeakers = unsigned(mSpeakers.size());
+    for (auto& speaker : mSpeakers) {
+      mSpeakerVecs.push_back(speaker.vec());
+      mDeviceChannels.push_back(speaker.deviceChannel);
+    }
+    mCache.allocate(kMaxSources, mNumSpeakers);
+    mTargetGains.resize(mNumSpeakers, 0.f);
+  }
+
+  void setFocus(float focus) {
+    mFocus = focus;
+    mCache.invalidate(); // force a recompute
+  }
+
+  void prepare(al::AudioIOData& io) override {
+    mCache.beginBlock();
+  }
+
+  void renderBuffer(al::AudioIOData& io, const al::Pose& reldir,
+                    const float* samples, const unsigned int& numFrames) override {
+    al::Vec3d relpos = toSpeakerSpace(reldir);
+    int index = mCache.claim(relpos);
+    if (index < 0) { // cache full, render uncached
+      computeGains(relpos, mTargetGains.data());
+      accumulate(io, mTargetGains.data(), samples, numFrames);
+      return;
+    }
+
+    float* gains = mCache.gains(index);
+    if (!mCache.moved(index, relpos)) {
+      accumulate(io, gains, samples, numFrames);
+      return;
+    }
+
+    computeGains(relpos, mTargetGains.data());
+    if (mCache.valid(index)) {
+      ramp(io, gains, mTargetGains.data(), samples, numFrames);
+    } else {
+      accumulate(io, mTargetGains.data(), samples, numFrames);
+    }
+    std::copy(mTargetGains.begin(), mTargetGains.end(), gains);
+    mCache.update(index, relpos);
+  }
+
+  void renderSample(al::AudioIOData& io, const al::Pose& reldir,
+                    const float& sample, const unsigned int& frameIndex) override {
+    computeGains(toSpeakerSpace(reldir), mTargetGains.data());
+    for (unsigned k = 0; k < mNumSpeakers; k++) {
+      io.out(mDeviceChannels[k], frameIndex) += mTargetGains[k] * sample;
+    }
+  }
+
+private:
+  unsigned mNumSpeakers = 0;
+  float mFocus = 1.f;
+  std::vector<al::Vec3d> mSpeakerVecs;
+  std::vector<int> mDeviceChannels;
+  SpatialGainCache mCache;
+  std::vector<float> mTargetGains; // scratch
+
+  // same axis convention as al::Dbap
+  static al::Vec3d toSpeakerSpace(const al::Pose& reldir) {
+    al::Vec3d relpos = reldir.vec();
+    return al::Vec3d(relpos.x, -relpos.z, relpos.y);
+  }
+
+  void computeGains(const al::Vec3d& relpos, float* gains) const {
+    for (unsigned k = 0; k < mNumSpeakers; k++) {
+      double dist = (relpos - mSpeakerVecs[k]).mag();
+      gains[k] = std::pow(1.f / (1.f + float(dist)), mFocus);
+    }
+  }
+
+  void accumulate(al::AudioIOData& io, const float* gains,
+                  const float* samples, unsigned numFrames) {
+    for (unsigned k = 0; k < mNumSpeakers; k++) {
+      const float gain = gains[k];
+      float* out = io.outBuffer(mDeviceChannels[k]);
+      for (unsigned i = 0; i < numFrames; i++) {
+        out[i] += gain * samples[i];
+      }
+    }
+  }
+
+  void ramp(al::AudioIOData& io, const float* from, const float* to,
+            const float* samples, unsigned numFrames) {
+    for (unsigned k = 0; k < mNumSpeakers; k++) {
+      const float step = (to[k] - from[k]) / float(numFrames);
+      const float start = from[k] + step;
+      float* out = io.outBuffer(mDeviceChannels[k]);
+      for (unsigned i = 0; i < numFrames; i++) {
+        out[i] += (start + step * float(i)) * samples[i];
+      }
+    }
+  }
+};
+
+#endif // EOYS_CACHED_DBAP
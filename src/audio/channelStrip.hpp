@@ -7,8 +7,6 @@
 
 #include "../../Gimmel/include/gimmel.hpp"
 #include "ampModeler.hpp"
-// #include "../../assets/namModels/MarshallModel.h"
-#include "../../assets/namModels/BassModel.h"
 
 #include "effectsEngine.hpp"
 #include "spatialAgent.hpp"
@@ -42,6 +40,11 @@ public:
     registerParameters(this->mPose); // need for distributed.
   }
 
+  // replicas mirror parameters only, see EffectsEngine::isProxy()
+  bool isProxy() const override {
+    return mIsReplica;
+  }
+
   // call after adding fx/amps to an agent
   void updateParameters() {
     for (auto& param : mParamBundles[0].parameters()) {
@@ -2,6 +2,7 @@
 #define EOYS_EFFECTS_ENGINE
 
 // std includes
+#include <string>
 #include <vector>
 #include <unordered_set>
 
@@ -13,6 +14,7 @@
 // giml includes
 #include "../Gimmel/include/gimmel.hpp"
 #include "ampModeler.hpp"
+#include "ampHotSwap.hpp"
 
 /**
  * @brief Basic encapsulation of the an fx chain / inserts, using `Gimmel`
@@ -20,6 +22,7 @@
 class EffectsEngine {
 public:
   std::vector<std::unique_ptr<giml::Effect<float>>> mEffects;
+  std::vector<giml::HotSwapAmp*> mAmps; // amps added from `.nam` files, in order
   giml::EffectsLine<float> mEffectsLine;
 
   // param handling 
@@ -31,32 +34,96 @@ public:
     mParamBundles.push_back(al::ParameterBundle("Effects"));
   }
 
+  virtual ~EffectsEngine() {}
+
+  /**
+   * @brief True for replicas on renderer nodes, which never process audio.
+   * A proxy gets the same parameters as the primary, so they stay in sync,
+   * but amps and effects are never built: no models, delay lines or reverbs.
+   */
+  virtual bool isProxy() const { return false; }
+
   template <typename T, typename Layer1, typename Layer2, class TWeights>
   void addAmp() {
+    if (isProxy()) { addAmpToggle(nullptr); return; }
     mEffects.push_back(std::make_unique<giml::AmpModeler<T, Layer1, Layer2>>());
     mEffectsLine.pushBack(mEffects.back().get());
     auto* amp = dynamic_cast<giml::AmpModeler<T, Layer1, Layer2>*>(mEffects.back().get());
     TWeights mWeights;
     amp->loadModel(mWeights.weights);
+    addAmpToggle(mEffects.back().get());
+  }
+
+  /**
+   * @brief Adds an amp from a `.nam` file at runtime, dispatching to one of the
+   * compiled kernels in namLoader.hpp, built for the best ISA this CPU supports
+   * (see namDispatch.hpp). Returns false if the model can't be used; the amp
+   * slot and its toggle are added anyway (passing audio through), so the
+   * parameter list still matches the proxies' and loadAmp() can fill it later.
+   */
+  bool addAmp(const std::string& namPath) {
+    if (isProxy()) { addAmpToggle(nullptr); return true; }
+    auto slot = std::make_unique<giml::HotSwapAmp>();
+    NamModel model;
+    std::unique_ptr<giml::Effect<float>> amp;
+    if (loadNamModel(namPath, model)) { amp = makeNamEffect(model, *activeNamBackend().table); }
+    const bool loaded = amp != nullptr;
+    if (loaded) {
+      slot->setModel(std::move(amp));
+    } else {
+      std::cerr << "EffectsEngine Error: Could not load amp " << namPath << ", passing audio through" << std::endl;
+    }
+    mAmps.push_back(slot.get());
+    mEffects.push_back(std::move(slot));
+    mEffectsLine.pushBack(mEffects.back().get());
+    addAmpToggle(mEffects.back().get());
+    return loaded;
+  }
 
+  /**
+   * @brief Swaps the model of an amp added with addAmp(namPath) while audio
+   * is running. Loading happens in the background, then the amp crossfades.
+   * @param index Which of this engine's amps to swap, in the order they were added
+   */
+  bool loadAmp(const std::string& namPath, size_t index = 0) {
+    if (isProxy()) { return true; }
+    if (index >= mAmps.size()) {
+      std::cerr << "EffectsEngine Error: No amp at index " << index << std::endl;
+      return false;
+    }
+    mAmps[index]->loadAsync(namPath);
+    return true;
+  }
+
+private:
+  // effectPtr is null on proxies, the toggle is only there to stay in sync
+  void addAmpToggle(giml::Effect<float>* effectPtr) {
     mParams.push_back(std::make_shared<al::ParameterBool>("Amp Enabled", "", false));
     // Get a pointer to the ParameterBool
     auto* theToggle = dynamic_cast<al::ParameterBool*>(mParams.back().get());
-    if (theToggle) {
-      auto* effectPtr = mEffects.back().get(); // Get pointer to current effect
+    if (theToggle && effectPtr) {
       theToggle->registerChangeCallback([effectPtr](float value) {
         bool enabled = value > 0.5f;
         effectPtr->toggle(enabled);
       });
     }
     mParamBundles.back().addParameter(mParams.back().get());
-
   }
 
+public:
   template<class TEffect, int SampleRate>
   void addEffect() {
-    mEffects.push_back(std::make_unique<TEffect>(SampleRate));
-    mEffectsLine.pushBack(mEffects.back().get());
+    // proxies only build a throwaway instance to read the param list from
+    std::unique_ptr<TEffect> probe;
+    giml::Effect<float>* effectPtr = nullptr;
+    if (isProxy()) {
+      probe = std::make_unique<TEffect>(SampleRate);
+    } else {
+      mEffects.push_back(std::make_unique<TEffect>(SampleRate));
+      mEffectsLine.pushBack(mEffects.back().get());
+      effectPtr = mEffects.back().get();
+    }
+    giml::Effect<float>* paramSource = effectPtr ? effectPtr : probe.get();
     auto effectName = al::demangle(typeid(TEffect).name());
 
     // TODO programmatic attach of effect params to GUI
@@ -64,15 +131,14 @@ public:
     mParams.push_back(std::make_shared<al::ParameterBool>(effectName + "Enabled", "", false));
     // Get a pointer to the ParameterBool
     auto* theToggle = dynamic_cast<al::ParameterBool*>(mParams.back().get());
-    if (theToggle) {
-      auto* effectPtr = mEffects.back().get(); // Get pointer to current effect
+    if (theToggle && effectPtr) {
       theToggle->registerChangeCallback([effectPtr](float value) {
         bool enabled = value > 0.5f;
         effectPtr->toggle(enabled);
       });
     }
 
-    for (auto* param : mEffects.back()->getParams()) {
+    for (auto* param : paramSource->getParams()) {
       switch (param->type) {
         case giml::Param<float>::TYPE::CONTINUOUS:
           mParams.push_back(std::make_shared<al::Parameter>(
@@ -93,14 +159,13 @@ public:
 
       // param callback
       auto* theParam = dynamic_cast<al::Parameter*>(mParams.back().get());
-      if (theParam) {
+      if (theParam && effectPtr) {
         std::string fullParamName = theParam->getName(); // e.g. "giml::Detune<float>pitchRatio"
         
         // Extract just the parameter name without the effect prefix
         std::string effectPrefix = effectName; // e.g. "giml::Detune<float>"
         std::string paramName = fullParamName.substr(effectPrefix.length()); // "pitchRatio"
         
-        auto* effectPtr = mEffects.back().get();
         theParam->registerChangeCallback([effectPtr, paramName](float value) {
           effectPtr->setParam(paramName, value);
           effectPtr->updateParams();
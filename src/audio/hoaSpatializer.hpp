@@ -0,0 +1,319 @@
+#ifndef EOYS_HOA_SPATIALIZER
+#define EOYS_HOA_SPATIALIZER
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// al includes
+#include "al/io/al_AudioIOData.hpp"
+#include "al/sound/al_Spatializer.hpp"
+
+// eoys includes
+#include "spatialGainCache.hpp"
+
+/**
+ * @brief Real spherical harmonics up to `order`, ACN channel order, N3D normalization.
+ *
+ * @param order Ambisonic order
+ * @param dir Unit direction, z up
+ * @param out (order + 1)^2 coefficients
+ */
+inline void realSphericalHarmonics(int order, const al::Vec3d& dir, double* out) {
+  const double z = std::max(-1.0, std::min(1.0, dir.z));
+  const double cosEl = std::sqrt(1.0 - z * z);
+  const double az = std::atan2(dir.y, dir.x);
+
+  // associated Legendre P_n^m(z), m >= 0, no Condon-Shortley phase
+  double P[8][8] = {};
+  P[0][0] = 1.0;
+  for (int m = 1; m <= order; m++) { P[m][m] = P[m - 1][m - 1] * (2 * m - 1) * cosEl; }
+  for (int m = 0; m < order; m++) { P[m + 1][m] = (2 * m + 1) * z * P[m][m]; }
+  for (int m = 0; m <= order; m++) {
+    for (int n = m + 2; n <= order; n++) {
+      P[n][m] = ((2 * n - 1) * z * P[n - 1][m] - (n + m - 1) * P[n - 2][m]) / (n - m);
+    }
+  }
+
+  for (int n = 0; n <= order; n++) {
+    for (int m = -n; m <= n; m++) {
+      const int am = std::abs(m);
+      double ratio = 1.0; // (n - |m|)! / (n + |m|)!
+      for (int k = n - am + 1; k <= n + am; k++) { ratio /= k; }
+      const double norm = std::sqrt((2 * n + 1) * (m == 0 ? 1.0 : 2.0) * ratio);
+      const double trig = m > 0 ? std::cos(m * az) : (m < 0 ? std::sin(am * az) : 1.0);
+      out[n * n + n + m] = norm * P[n][am] * trig;
+    }
+  }
+}
+
+/**
+ * @brief Higher-order ambisonic render path. Every source is encoded into one
+ * shared ambisonic bus and the bus is decoded to the speakers once per block,
+ * so each extra source costs (Order + 1)^2 multiply-adds per sample, no matter
+ * how many speakers there are.
+ *
+ * The decoder is AllRAD-style: the bus is max-rE decoded to a dense, uniform
+ * set of virtual speakers, and each virtual speaker is VBAP panned onto the real
+ * layout. This keeps irregular layouts like the AlloSphere's well behaved.
+ * Source encodings are cached and ramped the same way as CachedDbap's gains.
+ *
+ * Select it next to SPATIALIZER_TYPE in main.cpp, e.g. `HoaSpatializer<5>`.
+ */
+template <int Order>
+class HoaSpatializer : public al::Spatializer {
+  static_assert(Order >= 1 && Order <= 7, "HoaSpatializer supports orders 1 to 7");
+
+public:
+  static constexpr int kChannels = (Order + 1) * (Order + 1);
+  static constexpr int kMaxSources = 64;
+  static constexpr int kDefaultFrames = 4096; // bus length until a longer block shows up
+  static constexpr int kVirtualSpeakers = 2000;
+
+  HoaSpatializer(const al::Speakers& sl) : al::Spatializer(sl) {
+    mNumSpeakers = int(mSpeakers.size());
+    for (auto& speaker : mSpeakers) {
+      mDeviceChannels.push_back(speaker.deviceChannel);
+    }
+    mBus.assign(size_t(kChannels) * kDefaultFrames, 0.f);
+    mCache.allocate(kMaxSources, kChannels);
+    mTargetCoeffs.resize(kChannels, 0.f);
+    buildDecoder();
+  }
+
+  void prepare(al::AudioIOData& io) override {
+    mCache.beginBlock();
+    mFrames = 0;
+    const int frames = int(io.framesPerBuffer());
+    if (frames > mBusFrames) { // only on a buffer size change, the bus is empty between blocks
+      mBusFrames = frames;
+      mBus.assign(size_t(kChannels) * size_t(mBusFrames), 0.f);
+    }
+  }
+
+  void renderBuffer(al::AudioIOData& io, const al::Pose& reldir,
+                    const float* samples, const unsigned int& numFrames) override {
+    const unsigned frames = std::min(numFrames, unsigned(mBusFrames));
+    mFrames = std::max(mFrames, int(frames));
+
+    al::Vec3d relpos = toSpeakerSpace(reldir);
+    int index = mCache.claim(relpos);
+    if (index < 0) { // cache full, render uncached
+      encodeCoeffs(relpos, mTargetCoeffs.data());
+      encode(mTargetCoeffs.data(), samples, frames);
+      return;
+    }
+
+    float* coeffs = mCache.gains(index);
+    if (!mCache.moved(index, relpos)) {
+      encode(coeffs, samples, frames);
+      return;
+    }
+
+    encodeCoeffs(relpos, mTargetCoeffs.data());
+    if (mCache.valid(index)) {
+      encodeRamp(coeffs, mTargetCoeffs.data(), samples, frames);
+    } else {
+      encode(mTargetCoeffs.data(), samples, frames);
+    }
+    std::copy(mTargetCoeffs.begin(), mTargetCoeffs.end(), coeffs);
+    mCache.update(index, relpos);
+  }
+
+  void renderSample(al::AudioIOData& io, const al::Pose& reldir,
+                    const float& sample, const unsigned int& frameIndex) override {
+    if (frameIndex >= unsigned(mBusFrames)) { return; } // prepare() wasn't given this block
+    encodeCoeffs(toSpeakerSpace(reldir), mTargetCoeffs.data());
+    for (int c = 0; c < kChannels; c++) {
+      mBus[size_t(c) * mBusFrames + frameIndex] += mTargetCoeffs[c] * sample;
+    }
+    mFrames = std::max(mFrames, int(frameIndex) + 1);
+  }
+
+  // decode the bus to the speakers, then clear it for the next block
+  void finalize(al::AudioIOData& io) override {
+    const int frames = mFrames;
+    for (int k = 0; k < mNumSpeakers; k++) {
+      float* out = io.outBuffer(mDeviceChannels[k]);
+      const float* row = &mDecoder[size_t(k) * kChannels];
+      for (int c = 0; c < kChannels; c++) {
+        const float gain = row[c];
+        const float* bus = &mBus[size_t(c) * mBusFrames];
+        for (int i = 0; i < frames; i++) {
+          out[i] += gain * bus[i];
+        }
+      }
+    }
+    for (int c = 0; c < kChannels; c++) {
+      std::fill_n(&mBus[size_t(c) * mBusFrames], frames, 0.f);
+    }
+  }
+
+private:
+  int mNumSpeakers = 0;
+  int mFrames = 0;
+  int mBusFrames = kDefaultFrames;
+  std::vector<int> mDeviceChannels;
+  std::vector<float> mDecoder; // numSpeakers x kChannels
+  std::vector<float> mBus; // kChannels x mBusFrames
+  SpatialGainCache mCache;
+  std::vector<float> mTargetCoeffs; // scratch
+
+  // same axis convention as al::Dbap, z up
+  static al::Vec3d toSpeakerSpace(const al::Pose& reldir) {
+    al::Vec3d relpos = reldir.vec();
+    return al::Vec3d(relpos.x, -relpos.z, relpos.y);
+  }
+
+  static void encodeCoeffs(const al::Vec3d& relpos, float* coeffs) {
+    double mag = relpos.mag();
+    al::Vec3d dir = mag > 1e-6 ? relpos / mag : al::Vec3d(1, 0, 0);
+    double sh[kChannels];
+    realSphericalHarmonics(Order, dir, sh);
+    for (int c = 0; c < kChannels; c++) { coeffs[c] = float(sh[c]); }
+  }
+
+  void encode(const float* coeffs, const float* samples, unsigned numFrames) {
+    for (int c = 0; c < kChannels; c++) {
+      const float gain = coeffs[c];
+      float* bus = &mBus[size_t(c) * mBusFrames];
+      for (unsigned i = 0; i < numFrames; i++) {
+        bus[i] += gain * samples[i];
+      }
+    }
+  }
+
+  void encodeRamp(const float* from, const float* to, const float* samples, unsigned numFrames) {
+    for (int c = 0; c < kChannels; c++) {
+      const float step = (to[c] - from[c]) / float(numFrames);
+      const float start = from[c] + step;
+      float* bus = &mBus[size_t(c) * mBusFrames];
+      for (unsigned i = 0; i < numFrames; i++) {
+        bus[i] += (start + step * float(i)) * samples[i];
+      }
+    }
+  }
+
+  struct Triangle {
+    int speakers[3];
+    double inverse[3][3]; // inverse of the matrix with the speaker vectors as rows
+  };
+
+  // VBAP gains for a direction from the first triangle that contains it
+  static bool vbap(const std::vector<Triangle>& hull, const al::Vec3d& dir, double gains[3], int idx[3]) {
+    for (auto& tri : hull) {
+      double g[3];
+      for (int j = 0; j < 3; j++) {
+        g[j] = dir.x * tri.inverse[0][j] + dir.y * tri.inverse[1][j] + dir.z * tri.inverse[2][j];
+      }
+      if (g[0] < -1e-6 || g[1] < -1e-6 || g[2] < -1e-6) { continue; }
+      double norm = std::sqrt(g[0] * g[0] + g[1] * g[1] + g[2] * g[2]);
+      for (int j = 0; j < 3; j++) {
+        gains[j] = std::max(0.0, g[j]) / norm;
+        idx[j] = tri.speakers[j];
+      }
+      return true;
+    }
+    return false;
+  }
+
+  // faces of the convex hull of the speaker directions; fine for a few hundred speakers
+  std::vector<Triangle> speakerHull(const std::vector<al::Vec3d>& dirs) const {
+    std::vector<Triangle> hull;
+    const int n = int(dirs.size());
+    for (int a = 0; a < n; a++) {
+      for (int b = a + 1; b < n; b++) {
+        for (int c = b + 1; c < n; c++) {
+          al::Vec3d normal = cross(dirs[b] - dirs[a], dirs[c] - dirs[a]);
+          if (normal.magSqr() < 1e-12) { continue; }
+          bool above = false, below = false;
+          for (int p = 0; p < n && !(above && below); p++) {
+            double side = normal.dot(dirs[p] - dirs[a]);
+            if (side > 1e-9) { above = true; }
+            if (side < -1e-9) { below = true; }
+          }
+          if (above && below) { continue; }
+
+          const al::Vec3d& r0 = dirs[a];
+          const al::Vec3d& r1 = dirs[b];
+          const al::Vec3d& r2 = dirs[c];
+          double det = r0.dot(cross(r1, r2));
+          if (std::abs(det) < 1e-9) { continue; }
+          al::Vec3d c0 = cross(r1, r2) / det, c1 = cross(r2, r0) / det, c2 = cross(r0, r1) / det;
+          Triangle tri = { { a, b, c }, {
+            { c0.x, c1.x, c2.x },
+            { c0.y, c1.y, c2.y },
+            { c0.z, c1.z, c2.z } } };
+          hull.push_back(tri);
+        }
+      }
+    }
+    return hull;
+  }
+
+  void buildDecoder() {
+    std::vector<al::Vec3d> dirs;
+    for (auto& speaker : mSpeakers) {
+      al::Vec3d v = speaker.vec();
+      dirs.push_back(al::Vec3d(v.x, v.y, v.z).normalize());
+    }
+    std::vector<Triangle> hull = speakerHull(dirs);
+
+    // max-rE weights per order
+    double weights[Order + 1];
+    double x = std::cos(2.406809 / (Order + 1.51));
+    double p0 = 1.0, p1 = x;
+    weights[0] = 1.0;
+    for (int n = 1; n <= Order; n++) {
+      weights[n] = p1;
+      double p2 = ((2 * n + 1) * x * p1 - n * p0) / (n + 1);
+      p0 = p1;
+      p1 = p2;
+    }
+
+    // decode to a Fibonacci sphere of virtual speakers, then VBAP each onto the layout
+    std::vector<double> decoder(size_t(mNumSpeakers) * kChannels, 0.0);
+    std::vector<al::Vec3d> virtualDirs;
+    const double golden = M_PI * (3.0 - std::sqrt(5.0));
+    for (int l = 0; l < kVirtualSpeakers; l++) {
+      double z = 1.0 - 2.0 * (l + 0.5) / kVirtualSpeakers;
+      double r = std::sqrt(1.0 - z * z);
+      al::Vec3d dir(r * std::cos(golden * l), r * std::sin(golden * l), z);
+      virtualDirs.push_back(dir);
+
+      double gains[3]; int idx[3];
+      if (!vbap(hull, dir, gains, idx)) { continue; } // outside the layout
+      double sh[kChannels];
+      realSphericalHarmonics(Order, dir, sh);
+      for (int j = 0; j < 3; j++) {
+        for (int n = 0; n <= Order; n++) {
+          for (int c = n * n; c < (n + 1) * (n + 1); c++) {
+            decoder[size_t(idx[j]) * kChannels + c] += gains[j] * weights[n] * sh[c] / kVirtualSpeakers;
+          }
+        }
+      }
+    }
+
+    // normalize so a source carries unit energy on average
+    double energy = 0.0;
+    for (auto& dir : virtualDirs) {
+      double sh[kChannels];
+      realSphericalHarmonics(Order, dir, sh);
+      for (int k = 0; k < mNumSpeakers; k++) {
+        double g = 0.0;
+        for (int c = 0; c < kChannels; c++) { g += decoder[size_t(k) * kChannels + c] * sh[c]; }
+        energy += g * g;
+      }
+    }
+    double scale = energy > 0.0 ? 1.0 / std::sqrt(energy / virtualDirs.size()) : 1.0;
+    mDecoder.resize(decoder.size());
+    for (size_t i = 0; i < decoder.size(); i++) { mDecoder[i] = float(decoder[i] * scale); }
+
+    std::cout << "HoaSpatializer: order " << Order << ", " << kChannels << " channels, "
+              << mNumSpeakers << " speakers, " << hull.size() << " hull faces" << std::endl;
+  }
+};
+
+#endif // EOYS_HOA_SPATIALIZER
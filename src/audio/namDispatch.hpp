@@ -0,0 +1,221 @@
+#ifndef EOYS_NAM_DISPATCH
+#define EOYS_NAM_DISPATCH
+
+// std includes
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// the ISA modules only exist where CMakeLists.txt builds them: non-MSVC x86
+#if !defined(_WIN32) && (defined(__x86_64__) || defined(__i386__))
+#define EOYS_NAM_MODULES 1
+#include <dlfcn.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <mach-o/dyld.h>
+#endif
+#endif
+
+// Gamma includes
+#include "Gamma/SamplePlayer.h"
+
+// eoys includes
+#include "namLoader.hpp"
+
+/**
+ * @brief A set of compiled amp model kernels for one instruction set.
+ * The "builtin" backend is the table compiled into the app itself and is
+ * always available; the others come from the eoys_nam_<isa>.so modules.
+ */
+struct NamBackend {
+  std::string isa;
+  const std::vector<NamKernelEntry>* table = nullptr;
+};
+
+/**
+ * @brief True if the CPU (and OS) can run code built for the given ISA.
+ */
+inline bool namCpuSupports(const std::string& isa) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (isa == "avx512") {
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") &&
+           __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512bw") &&
+           __builtin_cpu_supports("fma");
+  }
+  if (isa == "avx2") { return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"); }
+  if (isa == "sse42") { return __builtin_cpu_supports("sse4.2"); }
+#endif
+  return isa == "builtin";
+}
+
+/**
+ * @brief Directory of the running executable, where CMake puts the
+ * eoys_nam_<isa>.so modules (bin/ or debug/). Empty if it can't be found.
+ */
+inline std::string namModuleDirectory() {
+  std::string path;
+#if defined(EOYS_NAM_MODULES) && defined(__APPLE__)
+  char buffer[4096];
+  uint32_t size = sizeof(buffer);
+  if (_NSGetExecutablePath(buffer, &size) == 0) { path = buffer; }
+#elif defined(EOYS_NAM_MODULES)
+  char buffer[4096];
+  const ssize_t length = readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
+  if (length > 0) { path.assign(buffer, size_t(length)); }
+#endif
+  const size_t slash = path.find_last_of('/');
+  return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+/**
+ * @brief Every backend module this machine can run, best first. Modules that
+ * are missing (not built for this platform) are skipped.
+ */
+inline std::vector<NamBackend> scanNamBackends() {
+  std::vector<NamBackend> backends;
+#if defined(EOYS_NAM_MODULES)
+  std::string directory = namModuleDirectory();
+  if (directory.empty()) { directory = "./"; }
+  for (const char* isa : { "avx512", "avx2", "sse42" }) {
+    if (!namCpuSupports(isa)) { continue; }
+    std::string path = directory + "eoys_nam_" + isa + ".so";
+    void* module = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!module) { continue; }
+    using TableFn = const std::vector<NamKernelEntry>* (*)();
+    auto tableFn = reinterpret_cast<TableFn>(dlsym(module, "eoysNamKernelTable"));
+    if (!tableFn) {
+      std::cerr << "NamDispatch Warning: " << path << " has no kernel table" << std::endl;
+      dlclose(module);
+      continue;
+    }
+    NamBackend backend;
+    backend.isa = isa;
+    backend.table = tableFn(); // module stays loaded for the life of the app
+    backends.push_back(backend);
+  }
+#endif
+
+  NamBackend builtin;
+  builtin.isa = "builtin";
+  builtin.table = &namKernelTable();
+  backends.push_back(builtin);
+  return backends;
+}
+
+/**
+ * @brief All backends usable on this machine, best first, the builtin table
+ * last. Scanned once; safe to call from any thread.
+ */
+inline const std::vector<NamBackend>& namBackends() {
+  static const std::vector<NamBackend> backends = scanNamBackends();
+  return backends;
+}
+
+/**
+ * @brief The best backend, or the one EOYS_NAM_ISA (e.g. "sse42", "builtin")
+ * asks for.
+ */
+inline const NamBackend* pickNamBackend() {
+  auto& backends = namBackends();
+  const NamBackend* active = &backends.front();
+  if (const char* forced = std::getenv("EOYS_NAM_ISA")) {
+    bool found = false;
+    for (auto& backend : backends) {
+      if (backend.isa == forced) { active = &backend; found = true; }
+    }
+    if (!found) {
+      std::cerr << "NamDispatch Warning: EOYS_NAM_ISA=" << forced << " unavailable" << std::endl;
+    }
+  }
+  std::cout << "NamDispatch: using " << active->isa << " amp kernels" << std::endl;
+  return active;
+}
+
+/**
+ * @brief The backend new amps are created with, picked once; safe to call
+ * from any thread.
+ */
+inline const NamBackend& activeNamBackend() {
+  static const NamBackend* const active = pickNamBackend();
+  return *active;
+}
+
+/**
+ * @brief Runs every available backend over a DI recording and reports speed
+ * and error-to-signal ratio (ESR) against the builtin backend's output.
+ *
+ * @param namPath Model to benchmark
+ * @param diPath Mono DI recording, or empty for a synthetic test signal
+ * (decaying plucks). Nothing is run if the recording can't be loaded.
+ * @param seconds Length of audio to process
+ */
+inline void benchmarkNamBackends(const std::string& namPath,
+                                 const std::string& diPath,
+                                 double seconds = 10.0) {
+  NamModel model;
+  if (!loadNamModel(namPath, model)) { return; }
+
+  const int length = int(seconds * model.sampleRate);
+  std::vector<float> input(length);
+  gam::SamplePlayer<float, gam::ipl::Trunc, gam::phsInc::Loop> di;
+  std::string source;
+  if (!diPath.empty()) {
+    if (!di.load(diPath.c_str()) || di.frames() == 0) {
+      std::cerr << "NamDispatch Error: Cannot load DI " << diPath << std::endl;
+      return;
+    }
+    for (int i = 0; i < length; i++) { input[i] = di.read(0, i % di.frames()); }
+    source = "DI recording " + diPath;
+  } else {
+    source = "synthetic test signal (no DI recording)";
+    for (int i = 0; i < length; i++) { // decaying plucks at 2 Hz
+      float t = float(i % int(model.sampleRate / 2)) / float(model.sampleRate);
+      input[i] = 0.5f * std::exp(-6.f * t) * std::sin(2.f * float(M_PI) * 110.f * t * (1.f + 0.01f * i / length));
+    }
+  }
+
+  auto& backends = namBackends();
+  std::vector<float> reference; // builtin output, always last in the list
+  std::vector<std::vector<float>> outputs(backends.size());
+  std::vector<double> nsPerSample(backends.size());
+
+  for (size_t b = backends.size(); b-- > 0;) {
+    auto amp = makeNamEffect(model, *backends[b].table);
+    if (!amp) { return; }
+    amp->toggle(true);
+    outputs[b].resize(length);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < length; i++) { outputs[b][i] = amp->processSample(input[i]); }
+    auto end = std::chrono::steady_clock::now();
+    nsPerSample[b] = std::chrono::duration<double, std::nano>(end - start).count() / length;
+  }
+  reference = outputs.back();
+
+  double refEnergy = 0.0;
+  for (float y : reference) { refEnergy += double(y) * y; }
+
+  std::cout << "Amp kernel benchmark: " << namPath << " (" << model.architectureKey << ")" << std::endl;
+  std::cout << "Input: " << source << ", " << seconds << " s" << std::endl;
+  std::cout << std::setw(10) << "isa" << std::setw(14) << "ns/sample"
+            << std::setw(14) << "x realtime" << std::setw(14) << "ESR" << std::endl;
+  for (size_t b = 0; b < backends.size(); b++) {
+    double err = 0.0;
+    for (int i = 0; i < length; i++) {
+      double d = double(outputs[b][i]) - reference[i];
+      err += d * d;
+    }
+    double esr = refEnergy > 0.0 ? err / refEnergy : 0.0;
+    std::cout << std::setw(10) << backends[b].isa
+              << std::setw(14) << std::fixed << std::setprecision(1) << nsPerSample[b]
+              << std::setw(14) << std::setprecision(1) << 1e9 / (nsPerSample[b] * model.sampleRate)
+              << std::setw(14) << std::scientific << std::setprecision(2) << esr
+              << std::defaultfloat << std::endl;
+  }
+}
+
+#endif // EOYS_NAM_DISPATCH
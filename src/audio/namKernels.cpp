@@ -0,0 +1,26 @@
+// Amp model kernels for one instruction set, built as a loadable module.
+// CMakeLists.txt compiles this file once per ISA (-msse4.2, -mavx2, ...) and
+// namDispatch.hpp picks the best module the CPU supports at startup.
+// Everything except the entry point below has hidden visibility, so the
+// Eigen/RTNeural code in each module never gets mixed up with another ISA's.
+
+#ifndef EOYS_NAM_ISA
+#define EOYS_NAM_ISA "generic"
+#endif
+
+// AVX widens Eigen's fixed-size members past the 16 bytes C++14 new guarantees
+#if defined(__AVX__) && __cplusplus < 201703L
+#error "AVX amp kernels need C++17 aligned new, see CMakeLists.txt"
+#endif
+
+#include "namLoader.hpp"
+
+extern "C" __attribute__((visibility("default")))
+const std::vector<NamKernelEntry>* eoysNamKernelTable() {
+  return &namKernelTable();
+}
+
+extern "C" __attribute__((visibility("default")))
+const char* eoysNamKernelIsa() {
+  return EOYS_NAM_ISA;
+}
@@ -0,0 +1,383 @@
+#ifndef EOYS_NAM_LOADER
+#define EOYS_NAM_LOADER
+
+// std includes
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+// RTNeural includes
+#include "../../RTNeural/modules/json/json.hpp"
+
+// eoys includes
+#include "ampModeler.hpp"
+
+/**
+ * @brief Config of a single WaveNet layer array, as found in a `.nam` file.
+ */
+struct NamLayerConfig {
+  int inputSize = 1;
+  int conditionSize = 1;
+  int headSize = 1;
+  int channels = 1;
+  int kernelSize = 1;
+  std::vector<int> dilations;
+  std::string activation;
+  bool gated = false;
+  bool headBias = false;
+};
+
+/**
+ * @brief A parsed `.nam` model: enough to pick a compiled kernel and load it.
+ */
+struct NamModel {
+  std::string name;
+  std::string architectureKey; // see namArchitectureKey()
+  double sampleRate = 48000.0;
+  std::vector<float> weights;
+};
+
+/**
+ * @brief Builds the key used to look up a compiled kernel for a WaveNet config.
+ * Two models with the same key can share the same RTWavenet instantiation.
+ */
+inline std::string namArchitectureKey(const std::vector<NamLayerConfig>& layers) {
+  std::stringstream key;
+  key << "WaveNet";
+  for (auto& layer : layers) {
+    key << "/" << layer.inputSize << "-" << layer.conditionSize << "-"
+        << layer.headSize << "-" << layer.channels << "-" << layer.kernelSize << "-[";
+    for (size_t i = 0; i < layer.dilations.size(); i++) {
+      key << (i ? "," : "") << layer.dilations[i];
+    }
+    key << "]-" << layer.activation << (layer.gated ? "-gated" : "")
+        << (layer.headBias ? "-bias" : "");
+  }
+  return key.str();
+}
+
+/**
+ * @brief Inverse of namArchitectureKey(), false if `key` isn't one it made.
+ */
+inline bool namLayersFromKey(const std::string& key, std::vector<NamLayerConfig>& layers) {
+  layers.clear();
+  std::stringstream stream(key);
+  std::string part;
+  if (!std::getline(stream, part, '/') || part != "WaveNet") { return false; }
+  while (std::getline(stream, part, '/')) {
+    NamLayerConfig layer;
+    std::stringstream fields(part);
+    char dash[5], open;
+    if (!(fields >> layer.inputSize >> dash[0] >> layer.conditionSize >> dash[1] >> layer.headSize >> dash[2] >>
+          layer.channels >> dash[3] >> layer.kernelSize >> dash[4] >> open) || open != '[') {
+      return false;
+    }
+    std::string dilations, rest;
+    if (!std::getline(fields, dilations, ']') || !std::getline(fields, rest)) { return false; }
+    std::stringstream dilationFields(dilations);
+    std::string dilation;
+    while (std::getline(dilationFields, dilation, ',')) {
+      std::stringstream value(dilation);
+      int d;
+      if (!(value >> d)) { return false; }
+      layer.dilations.push_back(d);
+    }
+    // rest is -activation[-gated][-bias]
+    std::stringstream flags(rest);
+    std::string flag;
+    if (!std::getline(flags, flag, '-') || !flag.empty() || !std::getline(flags, layer.activation, '-')) { return false; }
+    while (std::getline(flags, flag, '-')) {
+      if (flag == "gated") { layer.gated = true; }
+      else if (flag == "bias") { layer.headBias = true; }
+      else { return false; }
+    }
+    layers.push_back(layer);
+  }
+  return !layers.empty();
+}
+
+/**
+ * @brief Number of weights a WaveNet with the given layer arrays expects,
+ * in the order NAM serializes them (rechannel, layers, head rechannel, then head scale).
+ */
+inline size_t namExpectedWeightCount(const std::vector<NamLayerConfig>& layers) {
+  size_t count = 0;
+  for (auto& layer : layers) {
+    const size_t c = layer.channels;
+    const size_t convOut = layer.gated ? 2 * c : c;
+    count += layer.inputSize * c; // rechannel, no bias
+    for (size_t i = 0; i < layer.dilations.size(); i++) {
+      count += layer.kernelSize * c * convOut + convOut; // dilated conv
+      count += layer.conditionSize * convOut; // input mixin, no bias
+      count += c * c + c; // 1x1
+    }
+    count += c * layer.headSize + (layer.headBias ? layer.headSize : 0); // head rechannel
+  }
+  return count + 1; // head scale
+}
+
+// --- binary sidecar cache ---------------------------------------------------
+
+// bump when the sidecar layout changes
+static const char kNamSidecarMagic[8] = { 'E', 'O', 'Y', 'S', 'N', 'A', 'M', '1' };
+
+struct NamSidecarHeader {
+  char magic[8];
+  uint64_t sourceSize;
+  int64_t sourceModified;
+  double sampleRate;
+  uint32_t keyLength;
+  uint32_t weightCount;
+};
+
+inline std::string namSidecarPath(const std::string& namPath) {
+  return namPath + ".bin";
+}
+
+inline bool namSourceStat(const std::string& namPath, uint64_t& size, int64_t& modified) {
+  struct stat info;
+  if (stat(namPath.c_str(), &info) != 0) { return false; }
+  size = uint64_t(info.st_size);
+  modified = int64_t(info.st_mtime);
+  return true;
+}
+
+/**
+ * @brief Reads a sidecar written by writeNamSidecar(). Fails if the sidecar is
+ * missing, corrupt, or stale with respect to the `.nam` file it was made from,
+ * so the caller falls back to parsing the JSON.
+ */
+inline bool readNamSidecar(const std::string& namPath, NamModel& model) {
+  uint64_t size; int64_t modified;
+  if (!namSourceStat(namPath, size, modified)) { return false; }
+
+  std::ifstream file(namSidecarPath(namPath), std::ios::binary | std::ios::ate);
+  if (!file.is_open()) { return false; }
+  const uint64_t fileSize = uint64_t(file.tellg());
+  file.seekg(0);
+
+  NamSidecarHeader header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) { return false; }
+  if (std::memcmp(header.magic, kNamSidecarMagic, sizeof(kNamSidecarMagic)) != 0) { return false; }
+  if (header.sourceSize != size || header.sourceModified != modified) { return false; }
+  // the counts must account for the file exactly, so a damaged header can't ask for gigabytes
+  if (sizeof(header) + uint64_t(header.keyLength) + uint64_t(header.weightCount) * sizeof(float) != fileSize) {
+    return false;
+  }
+
+  std::string key(header.keyLength, '\0');
+  std::vector<float> weights(header.weightCount);
+  file.read(&key[0], header.keyLength);
+  file.read(reinterpret_cast<char*>(weights.data()), header.weightCount * sizeof(float));
+  if (!file) { return false; }
+
+  // same check parseNamFile() makes, the kernels trust the count
+  std::vector<NamLayerConfig> layers;
+  if (!namLayersFromKey(key, layers) || namExpectedWeightCount(layers) != weights.size()) { return false; }
+
+  model.architectureKey.swap(key);
+  model.weights.swap(weights);
+  model.sampleRate = header.sampleRate;
+  return true;
+}
+
+inline bool writeNamSidecar(const std::string& namPath, const NamModel& model) {
+  NamSidecarHeader header;
+  std::memcpy(header.magic, kNamSidecarMagic, sizeof(kNamSidecarMagic));
+  if (!namSourceStat(namPath, header.sourceSize, header.sourceModified)) { return false; }
+  header.sampleRate = model.sampleRate;
+  header.keyLength = uint32_t(model.architectureKey.size());
+  header.weightCount = uint32_t(model.weights.size());
+
+  // written aside and renamed into place, so a reader never sees a half-written sidecar;
+  // the name is per writer because several loaders can rewrite the same model at once
+  const std::string path = namSidecarPath(namPath);
+  std::string tempPath = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+#if !defined(_WIN32)
+  tempPath += "-" + std::to_string(getpid());
+#endif
+  {
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) { return false; }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(model.architectureKey.data(), header.keyLength);
+    file.write(reinterpret_cast<const char*>(model.weights.data()), header.weightCount * sizeof(float));
+    if (!file.flush()) {
+      file.close();
+      std::remove(tempPath.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+    std::remove(tempPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+// --- json parsing -----------------------------------------------------------
+
+/**
+ * @brief Parses a `.nam` file. Only WaveNet models are supported.
+ */
+inline bool parseNamFile(const std::string& namPath, NamModel& model) {
+  std::ifstream file(namPath);
+  if (!file.is_open()) {
+    std::cerr << "NamLoader Error: Cannot open file " << namPath << std::endl;
+    return false;
+  }
+
+  try {
+    nlohmann::json json;
+    file >> json;
+
+    if (json.at("architecture").get<std::string>() != "WaveNet") {
+      std::cerr << "NamLoader Error: Unsupported architecture "
+                << json.at("architecture") << " in " << namPath << std::endl;
+      return false;
+    }
+
+    std::vector<NamLayerConfig> layers;
+    for (auto& jsonLayer : json.at("config").at("layers")) {
+      NamLayerConfig layer;
+      layer.inputSize = jsonLayer.at("input_size");
+      layer.conditionSize = jsonLayer.at("condition_size");
+      layer.headSize = jsonLayer.at("head_size");
+      layer.channels = jsonLayer.at("channels");
+      layer.kernelSize = jsonLayer.at("kernel_size");
+      layer.dilations = jsonLayer.at("dilations").get<std::vector<int>>();
+      layer.activation = jsonLayer.at("activation").get<std::string>();
+      layer.gated = jsonLayer.at("gated");
+      layer.headBias = jsonLayer.at("head_bias");
+      layers.push_back(layer);
+    }
+
+    model.architectureKey = namArchitectureKey(layers);
+    model.weights = json.at("weights").get<std::vector<float>>();
+    if (json.count("sample_rate") && !json.at("sample_rate").is_null()) {
+      model.sampleRate = json.at("sample_rate");
+    }
+
+    size_t expected = namExpectedWeightCount(layers);
+    if (model.weights.size() != expected) {
+      std::cerr << "NamLoader Error: " << namPath << " has " << model.weights.size()
+                << " weights, architecture expects " << expected << std::endl;
+      return false;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "NamLoader Error: Failed to parse " << namPath << ": " << e.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Loads a `.nam` file, going through the binary sidecar when it is fresh
+ * and (re)writing it when it isn't. Safe to call off the audio thread only.
+ */
+inline bool loadNamModel(const std::string& namPath, NamModel& model) {
+  model.name = namPath;
+  if (readNamSidecar(namPath, model)) { return true; }
+  if (!parseNamFile(namPath, model)) { return false; }
+  if (!writeNamSidecar(namPath, model)) {
+    std::cerr << "NamLoader Warning: Could not write sidecar for " << namPath << std::endl;
+  }
+  return true;
+}
+
+// --- compiled kernels -------------------------------------------------------
+
+/**
+ * @brief Layer arrays for the stock NAM trainer presets. Each pair below gets its
+ * own fully inlined RTWavenet instantiation; anything else is rejected at load.
+ */
+namespace namArch {
+  using Dilations10 = wavenet::Dilations<1, 2, 4, 8, 16, 32, 64, 128, 256, 512>;
+  using Dilations7 = wavenet::Dilations<1, 2, 4, 8, 16, 32, 64>;
+  using Dilations13 = wavenet::Dilations<128, 256, 512, 1, 2, 4, 8, 16, 32, 64, 128, 256, 512>;
+
+  // Layer_Array<T, input, condition, head, channels, kernel, dilations, headBias, maths>
+  using StandardLayer1 = wavenet::Layer_Array<float, 1, 1, 8, 16, 3, Dilations10, false, NAMMathsProvider>;
+  using StandardLayer2 = wavenet::Layer_Array<float, 16, 1, 1, 8, 3, Dilations10, true, NAMMathsProvider>;
+
+  using LiteLayer1 = wavenet::Layer_Array<float, 1, 1, 6, 12, 3, Dilations7, false, NAMMathsProvider>;
+  using LiteLayer2 = wavenet::Layer_Array<float, 12, 1, 1, 6, 3, Dilations13, true, NAMMathsProvider>;
+
+  using FeatherLayer1 = wavenet::Layer_Array<float, 1, 1, 4, 8, 3, Dilations7, false, NAMMathsProvider>;
+  using FeatherLayer2 = wavenet::Layer_Array<float, 8, 1, 1, 4, 3, Dilations13, true, NAMMathsProvider>;
+
+  using NanoLayer1 = wavenet::Layer_Array<float, 1, 1, 2, 4, 3, Dilations7, false, NAMMathsProvider>;
+  using NanoLayer2 = wavenet::Layer_Array<float, 4, 1, 1, 2, 3, Dilations13, true, NAMMathsProvider>;
+} // namespace namArch
+
+using NamKernelFactory = std::unique_ptr<giml::Effect<float>> (*)(const std::vector<float>&);
+
+template <typename Layer1, typename Layer2>
+std::unique_ptr<giml::Effect<float>> makeNamKernel(const std::vector<float>& weights) {
+  auto amp = std::make_unique<giml::AmpModeler<float, Layer1, Layer2>>();
+  amp->loadModel(weights);
+  return std::move(amp);
+}
+
+struct NamKernelEntry {
+  const char* preset;
+  std::vector<NamLayerConfig> layers;
+  NamKernelFactory factory;
+};
+
+/**
+ * @brief Table of compiled kernels, keyed by namArchitectureKey().
+ */
+inline const std::vector<NamKernelEntry>& namKernelTable() {
+  auto layerPair = [](int channels, int head, std::vector<int> dil1, std::vector<int> dil2) {
+    NamLayerConfig l1, l2;
+    l1.inputSize = 1; l1.headSize = head; l1.channels = channels; l1.kernelSize = 3;
+    l1.dilations = dil1; l1.activation = "Tanh"; l1.headBias = false;
+    l2.inputSize = channels; l2.headSize = 1; l2.channels = head; l2.kernelSize = 3;
+    l2.dilations = dil2; l2.activation = "Tanh"; l2.headBias = true;
+    return std::vector<NamLayerConfig>{ l1, l2 };
+  };
+  const std::vector<int> d10 = { 1, 2, 4, 8, 16, 32, 64, 128, 256, 512 };
+  const std::vector<int> d7 = { 1, 2, 4, 8, 16, 32, 64 };
+  const std::vector<int> d13 = { 128, 256, 512, 1, 2, 4, 8, 16, 32, 64, 128, 256, 512 };
+
+  static const std::vector<NamKernelEntry> table = {
+    { "standard", layerPair(16, 8, d10, d10), &makeNamKernel<namArch::StandardLayer1, namArch::StandardLayer2> },
+    { "lite", layerPair(12, 6, d7, d13), &makeNamKernel<namArch::LiteLayer1, namArch::LiteLayer2> },
+    { "feather", layerPair(8, 4, d7, d13), &makeNamKernel<namArch::FeatherLayer1, namArch::FeatherLayer2> },
+    { "nano", layerPair(4, 2, d7, d13), &makeNamKernel<namArch::NanoLayer1, namArch::NanoLayer2> },
+  };
+  return table;
+}
+
+/**
+ * @brief Instantiates the compiled kernel matching a loaded model, with weights
+ * loaded, prepared and prewarmed. Returns nullptr if no kernel matches.
+ * @param table Kernel table to search, e.g. one picked by namDispatch.hpp
+ */
+inline std::unique_ptr<giml::Effect<float>> makeNamEffect(const NamModel& model,
+    const std::vector<NamKernelEntry>& table = namKernelTable()) {
+  for (auto& entry : table) {
+    if (namArchitectureKey(entry.layers) == model.architectureKey) {
+      std::cout << "NamLoader: " << model.name << " -> " << entry.preset << " kernel" << std::endl;
+      return entry.factory(model.weights);
+    }
+  }
+  std::cerr << "NamLoader Error: No compiled kernel for " << model.name
+            << " (" << model.architectureKey << ")" << std::endl;
+  return nullptr;
+}
+
+#endif // EOYS_NAM_LOADER
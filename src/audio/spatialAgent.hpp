@@ -4,7 +4,6 @@
 #include "al/graphics/al_Shapes.hpp"
 #include "al/math/al_Random.hpp"
 #include "al/ui/al_PickableManager.hpp"
-#include "al/graphics/al_Font.hpp"
 
 #include "../../Gimmel/include/filter.hpp"
 
@@ -93,14 +92,14 @@ public:
   }
 };
 
-class PickableMesh : public al::VAOMesh, public SelectablePickable {
+// CPU-side mesh for picking only, drawing is batched in AgentRenderer
+class PickableMesh : public al::Mesh, public SelectablePickable {
 private:
 public: 
   // init Mesh and Pickable in constructor
   PickableMesh() {
     addSphere(*this, 0.3);
     this->primitive(al::Mesh::LINE_STRIP);
-    this->update();
     this->set(*this);
   }
 };
@@ -108,7 +107,8 @@ public:
 /**
  * @class SpatialAgent
  * @brief A spatialized audio agent with logic for object-based sound spatialization. 
- * Includes a mesh for visualizing position, and a GUI.
+ * Includes a mesh for picking, and a GUI. Markers and labels for all agents
+ * are drawn together by AgentRenderer (see AudioManager::draw).
  */
 class SpatialAgent : public al::PositionedVoice {
 public:
@@ -117,7 +117,6 @@ public:
   unsigned int sampleRate;
   al::HSV color = al::HSV(1.0);
   PickableMesh mPickableMesh;
-  al::FontRenderer mFontRenderer;
   std::string mName;
 
   al::Parameter mAzimuth{ "Azimuth", "", 0.0, "", -180.0, 180.0 };
@@ -128,13 +127,11 @@ public:
 
   SpatialAgent(const char channelName[] = "No Name") {
     this->color = al::HSV(al::rnd::uniform(), 1.0, 1.0);
-    mFontRenderer.load(al::Font::defaultFont().c_str(), 64, 2048);
     mName = channelName;
     this->registerParameters(mAzimuth, mElevation, mDistance);
   }
 
   void setName(const char name[]) {
-    mFontRenderer.write(name);
     mGui.setTitle(name);
     mName = name;
   }
@@ -143,6 +140,10 @@ public:
     return mName;
   }
 
+  bool isReplica() const {
+    return mIsReplica;
+  }
+
   void init() {
     mGui.init(5, 5, false);
     mSpatializationParams << mAzimuth << mElevation << mDistance;
@@ -161,16 +162,8 @@ public:
     }
   }
 
-  void onProcess(al::Graphics& g) override {
-    if (!mIsReplica) {
-      g.color(this->color);
-      g.draw(mPickableMesh);
-      mFontRenderer.renderAt(g, al::Vec3d(0.0));
-
-      // TODO: PR this into FontRenderer
-      g.blending(false); // to undo blending call from FontRenderer 
-    }
-  }
+  // drawn in a batch with the other agents, see AgentRenderer
+  void onProcess(al::Graphics& g) override {}
 
   void set(float azimuthDeg, float elevationDeg, float distanceVal, float sizeVal) {
     al::Vec3f position = sphericalToCartesian(azimuthDeg, elevationDeg, distanceVal);
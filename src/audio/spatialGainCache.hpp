@@ -0,0 +1,104 @@
+#ifndef EOYS_SPATIAL_GAIN_CACHE
+#define EOYS_SPATIAL_GAIN_CACHE
+
+// std includes
+#include <cstdint>
+#include <vector>
+
+// al includes
+#include "al/math/al_Vec.hpp"
+
+/**
+ * @brief Per-source gain vectors for spatializers, reused while sources don't move.
+ *
+ * Spatializers only ever see source positions, not voices, so sources are
+ * matched to entries by position: a source that hasn't moved claims its own
+ * entry. A source that moved a little (e.g. dragged in audio mode) claims the
+ * nearest unclaimed entry, so the spatializer can ramp from that entry's gains.
+ * Anything further away than `kMoveRadius` gets a fresh entry.
+ * Everything is allocated up front; claim() is safe on the audio thread.
+ */
+class SpatialGainCache {
+public:
+  static constexpr double kStaticEpsilon = 1e-4; // metres, absorbs pose round-trip noise
+  static constexpr double kMoveRadius = 0.5; // metres per block a source can move and still ramp
+
+  /**
+   * @param maxSources Number of sources that can be cached at once
+   * @param width Number of gains per source (speakers, ambisonic channels, ...)
+   */
+  void allocate(int maxSources, int width) {
+    mWidth = width;
+    mEntries.assign(maxSources, Entry());
+    mGains.assign(size_t(maxSources) * width, 0.f);
+  }
+
+  // call once per audio block, before any claim()
+  void beginBlock() {
+    mBlock++;
+  }
+
+  void invalidate() {
+    for (auto& entry : mEntries) { entry.valid = false; }
+  }
+
+  /**
+   * @brief Claims the entry for a source rendered at `pos` this block.
+   * @return entry index, or -1 if every entry is in use
+   */
+  int claim(const al::Vec3d& pos) {
+    int nearest = -1, free = -1;
+    double nearestDist = kMoveRadius * kMoveRadius;
+    for (int i = 0; i < int(mEntries.size()); i++) {
+      Entry& entry = mEntries[i];
+      if (entry.lastBlock == mBlock) { continue; } // claimed by another source
+      if (!entry.valid || entry.lastBlock + 1 < mBlock) { // unused or stale
+        if (free < 0) { free = i; }
+        continue;
+      }
+      double d = (pos - entry.pos).magSqr();
+      if (d <= kStaticEpsilon * kStaticEpsilon) { nearest = i; break; } // hasn't moved
+      if (d < nearestDist) { nearestDist = d; nearest = i; }
+    }
+    int index = nearest >= 0 ? nearest : free;
+    if (index < 0) { return -1; }
+    if (nearest < 0) { mEntries[index].valid = false; }
+    mEntries[index].lastBlock = mBlock;
+    return index;
+  }
+
+  // true if the entry holds gains from a previous block
+  bool valid(int index) const {
+    return mEntries[index].valid;
+  }
+
+  // true if the entry's gains were computed for a different position
+  bool moved(int index, const al::Vec3d& pos) const {
+    const Entry& entry = mEntries[index];
+    return !entry.valid || (pos - entry.pos).magSqr() > kStaticEpsilon * kStaticEpsilon;
+  }
+
+  float* gains(int index) {
+    return &mGains[size_t(index) * mWidth];
+  }
+
+  // call after writing new gains for `pos` into gains(index)
+  void update(int index, const al::Vec3d& pos) {
+    mEntries[index].pos = pos;
+    mEntries[index].valid = true;
+  }
+
+private:
+  struct Entry {
+    al::Vec3d pos;
+    bool valid = false;
+    uint64_t lastBlock = 0;
+  };
+
+  int mWidth = 0;
+  std::vector<Entry> mEntries;
+  std::vector<float> mGains;
+  uint64_t mBlock = 1;
+};
+
+#endif // EOYS_SPATIAL_GAIN_CACHE
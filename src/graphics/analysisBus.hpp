@@ -0,0 +1,302 @@
+#ifndef EOYS_ANALYSIS_BUS_HPP
+#define EOYS_ANALYSIS_BUS_HPP
+
+// std includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// al includes
+#include "al/io/al_AudioIOData.hpp"
+
+// eoys includes
+#include "audioReactor.hpp"
+#include "beatTracker.hpp"
+#include "constantQ.hpp"
+#include "featureExtractor.hpp"
+#include "lockFreeQueue.hpp"
+#include "logSpectrum.hpp"
+#include "onsetDetector.hpp"
+#include "pitchTracker.hpp"
+
+/**
+ * @brief One chunk of one input channel, handed from the audio thread to
+ * the analysis thread.
+ */
+struct AnalysisBlock {
+  static constexpr unsigned kMaxFrames = 256;
+  uint64_t sampleTime = 0; // of samples[0]
+  unsigned channel = 0;
+  unsigned frames = 0;
+  float samples[kMaxFrames];
+};
+
+/**
+ * @brief Runs the listeners from audioReactor.hpp and a FeatureExtractor once per input channel,
+ * shared by every voice that reacts to that channel. Channels only cost
+ * anything once someone subscribes to them.
+ *
+ * The audio thread calls process() once per block (AudioManager does this
+ * before rendering the scene), which only copies subscribed inputs into a
+ * lock-free queue. The analysis thread (see start()) does the STFTs,
+ * features, onsets and pitch, so FFT bursts never land in the audio deadline.
+ * Readers call subscribe() and latest() from any thread. Frames go through a
+ * FrameReporter, so a reader always gets a whole frame from one hop, stamped
+ * with the sample time it ends at.
+ */
+class AnalysisBus {
+public:
+  ~AnalysisBus() {
+    stopThread();
+  }
+
+  /**
+   * @brief Builds analyzers for `numChannels` inputs. Call before audio
+   * starts, then start() on the node whose audio callback calls process().
+   */
+  void allocate(unsigned numChannels, float sampleRate = 44100.f) {
+    stopThread();
+    mSampleRate = sampleRate;
+    mChannels.clear();
+    for (unsigned i = 0; i < numChannels; i++) {
+      mChannels.push_back(std::make_unique<Channel>());
+      mChannels.back()->pitch.setSampleRate(sampleRate);
+      mChannels.back()->onset.setSampleRate(sampleRate);
+      mChannels.back()->constantQ.configure(sampleRate); // kernel is built once, then shared
+    }
+  }
+
+  // starts the analysis thread; nodes that never call process() don't need it
+  void start() {
+    if (mThread.joinable()) { return; }
+    mStopping = false;
+    mThread = std::thread([this]() { run(); });
+  }
+
+  unsigned numChannels() const {
+    return unsigned(mChannels.size());
+  }
+
+  // start analyzing `channel`, cheap enough to call every frame
+  void subscribe(unsigned channel) {
+    if (channel < mChannels.size()) {
+      mChannels[channel]->subscribed.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  // latest frame for `channel`, zeroed if nothing has been computed yet
+  FeatureFrame latest(unsigned channel) const {
+    if (channel >= mChannels.size()) { return FeatureFrame(); }
+    return mChannels[channel]->reporter.reportValue();
+  }
+
+  // latest log spectrum and waveform for `channel`, for AudioTextures
+  SpectrumFrame latestSpectrum(unsigned channel) const {
+    if (channel >= mChannels.size()) { return SpectrumFrame(); }
+    return mChannels[channel]->spectrumReporter.reportValue();
+  }
+
+  /**
+   * @brief Follows the tempo of `channel` (e.g. the kick) on a low-priority
+   * thread, see BeatTracker. Call after allocate().
+   */
+  void trackBeats(unsigned channel) {
+    if (channel >= mChannels.size()) {
+      std::cerr << "AnalysisBus Error: No input channel " << channel << " to track beats on" << std::endl;
+      return;
+    }
+    subscribe(channel);
+    mBeatChannel.store(int(channel));
+    mBeatTracker.start(mSampleRate, OnsetDetector::kHop);
+  }
+
+  /**
+   * @brief Adds pitch and pitch confidence to `channel`'s frames. Only worth
+   * it on monophonic sources (voice, a single guitar), see PitchTracker.
+   */
+  void trackPitch(unsigned channel) {
+    if (channel >= mChannels.size()) {
+      std::cerr << "AnalysisBus Error: No input channel " << channel << " to track pitch on" << std::endl;
+      return;
+    }
+    subscribe(channel);
+    mChannels[channel]->pitched.store(true, std::memory_order_relaxed);
+  }
+
+  BeatState beat() const {
+    return mBeatTracker.state();
+  }
+
+  // 0 on the beat, rising to 1 just before the next one
+  float beatPhase() const {
+    BeatState state = beat();
+    if (state.period <= 0.0) { return 0.f; }
+    double beats = double(sampleTime() - std::min(sampleTime(), state.lastBeatTime)) / state.period;
+    return float(beats - std::floor(beats));
+  }
+
+  // input samples received so far, the clock FeatureFrame and BeatState times refer to
+  uint64_t sampleTime() const {
+    return mSampleTime.load(std::memory_order_relaxed);
+  }
+
+  // blocks the analysis thread couldn't keep up with, should stay 0
+  uint64_t overruns() const {
+    return mOverruns.load(std::memory_order_relaxed);
+  }
+
+  // audio thread: copy, nothing else
+  void process(al::AudioIOData& io) {
+    unsigned channels = std::min(numChannels(), unsigned(io.channelsIn()));
+    const unsigned frames = io.framesPerBuffer();
+    const uint64_t blockStart = mSampleTime.load(std::memory_order_relaxed);
+    for (unsigned c = 0; c < channels; c++) {
+      if (!mChannels[c]->subscribed.load(std::memory_order_relaxed)) { continue; }
+      for (unsigned offset = 0; offset < frames; offset += AnalysisBlock::kMaxFrames) {
+        AnalysisBlock* block = mBlocks.writeSlot();
+        if (!block) { // analysis fell behind, skip rather than wait
+          mOverruns.fetch_add(1, std::memory_order_relaxed);
+          break;
+        }
+        block->sampleTime = blockStart + offset;
+        block->channel = c;
+        block->frames = std::min(AnalysisBlock::kMaxFrames, frames - offset);
+        for (unsigned i = 0; i < block->frames; i++) {
+          block->samples[i] = io.in(c, offset + i);
+        }
+        mBlocks.commitWrite();
+      }
+    }
+    mSampleTime.store(blockStart + frames, std::memory_order_relaxed);
+  }
+
+private:
+  struct Channel {
+    std::atomic<bool> subscribed { false };
+    std::atomic<bool> pitched { false };
+    SpectralListener spectrum;
+    DynamicListener dynamics;
+    OnsetDetector onset;
+    PitchTracker pitch;
+    ConstantQ constantQ;
+    FeatureExtractor extractor;
+    FeatureFrame frame; // analysis thread's copy of the last frame
+    FrameReporter<FeatureFrame> reporter;
+    LogSpectrum logSpectrum;
+    float history[4 * SpectrumFrame::kWaveform] = {}; // ring of recent input
+    unsigned historyIndex = 0;
+    FrameReporter<SpectrumFrame> spectrumReporter;
+
+    Channel() {
+      dynamics.setSilenceThresh(0.1);
+      extractor.configure(int(spectrum.stft.numBins()), spectrum.stft.binFreq());
+      logSpectrum.configure(int(spectrum.stft.numBins()), spectrum.stft.binFreq());
+    }
+
+    void record(float sample) {
+      history[historyIndex] = sample;
+      historyIndex = (historyIndex + 1) % (4 * SpectrumFrame::kWaveform);
+    }
+
+    void publish(uint64_t sampleTime) {
+      FeatureFrame next;
+      if (!spectrum.getMagnitudes().empty()) {
+        extractor.process(spectrum.getMagnitudes().data(), next);
+      }
+      next.sampleTime = sampleTime;
+      next.rms = dynamics.getRMS();
+      next.pitch = pitch.frequency();
+      next.pitchConfidence = pitch.confidence();
+      std::copy(frame.constantQ, frame.constantQ + FeatureFrame::kMaxConstantQBands, next.constantQ);
+      next.onsets = frame.onsets;
+      next.lastOnsetTime = frame.lastOnsetTime;
+      frame = next;
+      reporter.write(frame);
+
+      SpectrumFrame shaderFrame;
+      shaderFrame.sampleTime = sampleTime;
+      if (!spectrum.getMagnitudes().empty()) {
+        logSpectrum.process(spectrum.getMagnitudes().data(), shaderFrame.spectrum);
+      }
+      for (int i = 0; i < SpectrumFrame::kWaveform; i++) { // oldest first
+        shaderFrame.waveform[i] = history[(historyIndex + 4 * i) % (4 * SpectrumFrame::kWaveform)];
+      }
+      spectrumReporter.write(shaderFrame);
+    }
+  };
+
+  std::vector<std::unique_ptr<Channel>> mChannels;
+  SpscQueue<AnalysisBlock> mBlocks { 512 }; // ~3s of input at 44.1kHz in all, split between the subscribed channels
+  std::atomic<uint64_t> mOverruns { 0 };
+  std::thread mThread;
+  std::atomic<bool> mStopping { false };
+  BeatTracker mBeatTracker;
+  std::atomic<int> mBeatChannel { -1 };
+  std::atomic<uint64_t> mSampleTime { 0 };
+  float mSampleRate = 44100.f;
+
+  void stopThread() {
+    mStopping = true;
+    if (mThread.joinable()) { mThread.join(); }
+  }
+
+  // analysis thread
+  void run() {
+    while (!mStopping.load()) {
+      const AnalysisBlock* block;
+      bool idle = true;
+      while ((block = mBlocks.readSlot())) {
+        analyze(*block);
+        mBlocks.commitRead();
+        idle = false;
+      }
+      if (idle) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+    }
+  }
+
+  void analyze(const AnalysisBlock& block) {
+    Channel& channel = *mChannels[block.channel];
+    const bool pitched = channel.pitched.load(std::memory_order_relaxed);
+    const bool beats = mBeatChannel.load(std::memory_order_relaxed) == int(block.channel);
+    for (unsigned i = 0; i < block.frames; i++) {
+      const float in = block.samples[i];
+      const uint64_t now = block.sampleTime + i;
+      channel.dynamics.process(in);
+      channel.record(in);
+      if (pitched) { channel.pitch.process(in); }
+      if (channel.constantQ.process(in)) { // lands in the next published frame
+        const int bands = std::min(channel.constantQ.numBands(), FeatureFrame::kMaxConstantQBands);
+        std::copy(channel.constantQ.magnitudes().begin(), channel.constantQ.magnitudes().begin() + bands,
+                  channel.frame.constantQ);
+      }
+      OnsetEvent event;
+      if (channel.onset.process(in, now, event)) {
+        channel.frame.onsets++;
+        channel.frame.lastOnsetTime = event.sampleTime;
+        channel.reporter.write(channel.frame); // don't wait for the next hop
+      }
+      if (beats && channel.onset.hopped()) {
+        mBeatTracker.push({ now, channel.onset.flux() });
+      }
+      if (channel.spectrum.process(in)) { // once per hop
+        channel.publish(now + 1);
+      }
+    }
+  }
+};
+
+/**
+ * @brief The process-wide bus, fed by AudioManager and read by voices.
+ */
+inline AnalysisBus& analysisBus() {
+  static AnalysisBus bus;
+  return bus;
+}
+
+#endif // EOYS_ANALYSIS_BUS_HPP
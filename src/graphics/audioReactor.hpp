@@ -8,10 +8,16 @@
 #include "Gamma/tbl.h"
 //#include "Gamma/"
 
+#include <atomic>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 #include <vector>
 
+#include "featureExtractor.hpp"
+
 
 
 
@@ -33,9 +39,9 @@ public:
   }
 
 /**
- * @brief Call in on sound. Pass in input samples
+ * @brief Call in on sound. Pass in input samples. Returns true when a new spectrum is ready (once per hop)
  */
-  void process(float inputSample) {
+  bool process(float inputSample) {
     if (stft(inputSample)) { // if sample != null basically
       stft.spctToPolar();    // converts complex/ imaginary numbers to mag and
       // phase
@@ -45,7 +51,9 @@ public:
       if (mags){ //might not need this but seemed to be extra protection from seg fault on init - magnitudes are only assigned if there are values- no null pointer
       magnitudes.assign(mags, mags + stft.numBins());
       }
+      return true;
     }
+    return false;
   }
 
   const std::vector<float> &getMagnitudes() const {
@@ -106,7 +114,7 @@ public:
 * Need to call process in onSound. 
 * used .setOnsetThreshold and .setSilenceThresh based on audio input needs
 * Call retrieval functions in onSound. Not useful to print / send values at audio rate.
-* RMS is reset after 1 second of silence (below silence threshold). Update silence duration based on samplerate. This allows for new onset detection rather than a longterm RMS.
+* RMS is taken over the last 1024 samples (see WindowedRms), and cleared after 1 second of silence (below silence threshold). Update silence duration based on samplerate.
 */
 
 class DynamicListener {
@@ -116,8 +124,7 @@ class DynamicListener {
   // gam::ZeroCross<float> zrc;
 
   float currentRMS;
-  float sumOfSquares;
-  int sampleCounter;
+  WindowedRms window;
   //float onsetThreshMin;
   float onsetThreshMax;
   bool onsetStateOn;
@@ -127,7 +134,7 @@ class DynamicListener {
 
   //keeping consistent with how spectral listener is designed, avoiding undefined behavior, 
   DynamicListener () 
-    : currentRMS(0.0f), sumOfSquares(0.0f), sampleCounter(0), 
+    : currentRMS(0.0f), window(1024),
       onsetThreshMax(0.05), onsetStateOn(false), 
       silenceDuration(44100), silenceThreshold(0.01f) {} // 2048 samples of quiet before reset
 
@@ -145,8 +152,7 @@ class DynamicListener {
 // defined first so reset works in process
       void resetRMS(){
     currentRMS = 0.0f;
-    sampleCounter = 0;
-    sumOfSquares = 0.0f;
+    window.reset();
   }
 
 /** 
@@ -156,8 +162,7 @@ class DynamicListener {
     // env(inputSample);
     // zrc(inputSample); 
 
-    sumOfSquares += inputSample * inputSample; //squaring raw input sample value and summing.
-    sampleCounter++;
+    window.process(inputSample);
 
     // reset RMS if silence is detected using gamma's SilenceDetect
     if (silenceDuration(inputSample, silenceThreshold)) {
@@ -166,9 +171,7 @@ class DynamicListener {
       
       //std::cout << "Silence detected — RMS reset" << std::endl;
     }
-    if (sampleCounter > 0){
-       currentRMS = std::sqrt(sumOfSquares / sampleCounter);
-    }
+    currentRMS = window.rms();
 
   }
 
@@ -205,23 +208,61 @@ class DynamicListener {
 //!!
 //mostly Joel's code, slight modifications
 //!!
-//* use atomic for thread safety?
+// now a seqlock, so whole frames cross threads without tearing or locks
+
+/**
+* @brief Hands a value from one writer thread (e.g. AnalysisBus's analysis thread) to any number of readers on other threads.
+* One writer only. The writer never waits; a reader retries if it catches a write in progress.
+* T must be trivially copyable, e.g. FeatureFrame. It is stored as atomic words, so there are no data races.
+*/
+template <class T>
+class FrameReporter {
+static_assert(std::is_trivially_copyable<T>::value, "FrameReporter needs a trivially copyable type");
+static constexpr size_t kWords = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
 
-class FloatReporter {
-private:
-float value = 0.f;
+std::atomic<uint32_t> sequence { 0 }; // odd while a write is in progress
+std::atomic<uint32_t> words[kWords];
 
 public:
 
-// CALL IN AUDIO CALLBACK
-void write(float newValue) {
-  this->value = newValue;
+FrameReporter() {
+  write(T());
+}
+
+// CALL FROM THE ONE WRITER THREAD
+void write(const T& newValue) {
+  uint32_t buffer[kWords] = {};
+  std::memcpy(buffer, &newValue, sizeof(T));
+  const uint32_t seq = sequence.load(std::memory_order_relaxed);
+  sequence.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i < kWords; i++) {
+    words[i].store(buffer[i], std::memory_order_relaxed);
+  }
+  sequence.store(seq + 2, std::memory_order_release);
 }
 
 // CALL IN ANIMATION / DRAW CALLBACK
 
-float reportValue(){
-  return this->value;
+T reportValue() const {
+  uint32_t buffer[kWords];
+  uint32_t before, after;
+  do {
+    before = sequence.load(std::memory_order_acquire);
+    for (size_t i = 0; i < kWords; i++) {
+      buffer[i] = words[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = sequence.load(std::memory_order_relaxed);
+  } while (before != after || (before & 1));
+  T value;
+  std::memcpy(&value, buffer, sizeof(T));
+  return value;
+}
+
+// changes every write, lets readers skip frames they've already seen
+uint32_t version() const {
+  return sequence.load(std::memory_order_acquire);
 }
 
 };
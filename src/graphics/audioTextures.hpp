@@ -0,0 +1,111 @@
+#ifndef EOYS_AUDIO_TEXTURES_HPP
+#define EOYS_AUDIO_TEXTURES_HPP
+
+// std includes
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+// al includes
+#include "al/graphics/al_OpenGL.hpp"
+#include "al/graphics/al_Shader.hpp"
+#include "al/graphics/al_Texture.hpp"
+
+// eoys includes
+#include "logSpectrum.hpp"
+
+/**
+ * @brief The spectrum and waveform of a SpectrumFrame as two one-row
+ * textures, `u_spectrum` (64 wide) and `u_waveform` (128 wide, 0.5 = silence).
+ *
+ * Each is double-buffered: a frame uploads into the texture the GPU isn't
+ * reading from the previous frame, so the upload never waits on a draw.
+ *
+ * Frames travel to replicas as a short string, one printable 6-bit character
+ * per value (192 bytes for both), see encode() / decode().
+ */
+class AudioTextures {
+public:
+  static constexpr int kSpectrumUnit = 1;
+  static constexpr int kWaveformUnit = 2;
+  static constexpr int kEncodedSize = SpectrumFrame::kBins + SpectrumFrame::kWaveform;
+
+  // primary: quantize a frame for a ParameterString
+  static std::string encode(const SpectrumFrame& frame) {
+    std::string out(kEncodedSize, '0');
+    for (int i = 0; i < SpectrumFrame::kBins; i++) {
+      out[i] = quantize(frame.spectrum[i]);
+    }
+    for (int i = 0; i < SpectrumFrame::kWaveform; i++) {
+      out[SpectrumFrame::kBins + i] = quantize(0.5f + 0.5f * frame.waveform[i]);
+    }
+    return out;
+  }
+
+  // any node: unpack what encode() made, ignores anything malformed
+  void decode(const std::string& encoded) {
+    if (encoded.size() != size_t(kEncodedSize)) { return; }
+    for (int i = 0; i < SpectrumFrame::kBins; i++) {
+      mSpectrum[i] = dequantize(encoded[i]);
+    }
+    for (int i = 0; i < SpectrumFrame::kWaveform; i++) {
+      mWaveform[i] = dequantize(encoded[SpectrumFrame::kBins + i]);
+    }
+    mDirty = true;
+  }
+
+  /**
+   * @brief Uploads the latest decoded frame, if any, and binds both textures
+   * to `shader`. Call on the graphics thread with `shader` active.
+   */
+  void bind(al::ShaderProgram& shader) {
+    if (!mCreated) { create(); }
+    if (mDirty) {
+      mCurrent ^= 1;
+      mSpectrumTex[mCurrent].submit(mSpectrum, GL_RED, GL_UNSIGNED_BYTE);
+      mWaveformTex[mCurrent].submit(mWaveform, GL_RED, GL_UNSIGNED_BYTE);
+      mDirty = false;
+    }
+    mSpectrumTex[mCurrent].bind(kSpectrumUnit);
+    mWaveformTex[mCurrent].bind(kWaveformUnit);
+    shader.uniform("u_spectrum", kSpectrumUnit);
+    shader.uniform("u_waveform", kWaveformUnit);
+  }
+
+  void unbind() {
+    mSpectrumTex[mCurrent].unbind(kSpectrumUnit);
+    mWaveformTex[mCurrent].unbind(kWaveformUnit);
+  }
+
+private:
+  al::Texture mSpectrumTex[2], mWaveformTex[2];
+  uint8_t mSpectrum[SpectrumFrame::kBins] = {};
+  uint8_t mWaveform[SpectrumFrame::kWaveform] = {};
+  int mCurrent = 0;
+  bool mCreated = false, mDirty = false;
+
+  static char quantize(float value) {
+    return char('0' + int(std::min(1.f, std::max(0.f, value)) * 63.f + 0.5f));
+  }
+
+  static uint8_t dequantize(char c) {
+    int q = std::min(63, std::max(0, int(c) - '0'));
+    return uint8_t(q * 255 / 63);
+  }
+
+  void create() {
+    mCreated = true;
+    std::fill(mWaveform, mWaveform + SpectrumFrame::kWaveform, uint8_t(128)); // flat line
+    for (int i = 0; i < 2; i++) {
+      mSpectrumTex[i].create2D(SpectrumFrame::kBins, 1, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+      mWaveformTex[i].create2D(SpectrumFrame::kWaveform, 1, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+      for (al::Texture* tex : { &mSpectrumTex[i], &mWaveformTex[i] }) {
+        tex->filter(GL_LINEAR);
+        tex->wrap(GL_CLAMP_TO_EDGE);
+      }
+    }
+    mDirty = true;
+  }
+};
+
+#endif // EOYS_AUDIO_TEXTURES_HPP
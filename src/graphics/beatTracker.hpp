@@ -0,0 +1,221 @@
+#ifndef EOYS_BEAT_TRACKER_HPP
+#define EOYS_BEAT_TRACKER_HPP
+
+// std includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#if defined(__APPLE__)
+#include <pthread.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// eoys includes
+#include "audioReactor.hpp"
+#include "lockFreeQueue.hpp"
+
+/**
+ * @brief Drops the calling thread below normal priority, so analysis work
+ * yields to audio, graphics and networking when the machine is busy.
+ */
+inline void lowerThreadPriority() {
+#if defined(__APPLE__)
+  pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+#elif defined(__linux__)
+  setpriority(PRIO_PROCESS, pid_t(syscall(SYS_gettid)), 10); // per-thread nice on Linux
+#endif
+}
+
+/**
+ * @brief One hop of onset strength, pushed by AnalysisBus's analysis thread.
+ */
+struct EnvelopeSample {
+  uint64_t sampleTime = 0;
+  float flux = 0.f;
+};
+
+/**
+ * @brief Latest tempo estimate. `lastBeatTime` and `period` are in input
+ * samples, so a reader can place the beat against the bus's sample clock.
+ */
+struct BeatState {
+  float bpm = 0.f; // 0 until there's enough signal
+  float confidence = 0.f; // 0..1, autocorrelation at the beat lag over lag 0
+  double period = 0.0; // samples per beat
+  uint64_t lastBeatTime = 0;
+};
+
+/**
+ * @brief Tempo and beat phase from an onset-strength envelope.
+ *
+ * AnalysisBus's analysis thread only pushes one EnvelopeSample per onset hop
+ * (see OnsetDetector). A low-priority thread of its own decimates the
+ * envelope by two, keeps about six seconds of it, and every quarter second:
+ *  - autocorrelates it over 60-200 BPM lags, weighted by a log-normal
+ *    prior around 120 BPM so half/double tempo don't win on ties,
+ *  - refines the winning lag by parabolic interpolation,
+ *  - finds the phase whose comb of beats at that period collects the most
+ *    onset strength, giving the time of the latest beat.
+ */
+class BeatTracker {
+public:
+  static constexpr int kDecimation = 2;
+  static constexpr int kLength = 1024; // decimated envelope samples, ~6s
+  static constexpr int kUpdateEvery = 43; // decimated samples, ~0.25s
+  float minBpm = 60.f, maxBpm = 200.f, preferredBpm = 120.f;
+
+  BeatTracker() : mQueue(2048) {
+    mEnvelope.assign(kLength, 0.f);
+    mLinear.assign(kLength, 0.f);
+  }
+
+  ~BeatTracker() {
+    stop();
+  }
+
+  /**
+   * @param sampleRate Input sample rate
+   * @param hop Samples between envelope values, e.g. OnsetDetector::kHop
+   */
+  void start(float sampleRate, unsigned hop) {
+    if (mThread.joinable()) { return; }
+    mSampleRate = sampleRate;
+    mStep = double(hop) * kDecimation;
+    mStopping = false;
+    mThread = std::thread([this]() {
+      lowerThreadPriority();
+      while (!mStopping.load()) {
+        drain();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    });
+  }
+
+  void stop() {
+    mStopping = true;
+    if (mThread.joinable()) { mThread.join(); }
+  }
+
+  // analysis thread, never waits
+  void push(const EnvelopeSample& sample) {
+    mQueue.push(sample); // if the tracker falls behind we lose a hop, not the deadline
+  }
+
+  BeatState state() const {
+    return mState.reportValue();
+  }
+
+private:
+  SpscQueue<EnvelopeSample> mQueue;
+  FrameReporter<BeatState> mState;
+  std::thread mThread;
+  std::atomic<bool> mStopping { false };
+  float mSampleRate = 44100.f;
+  double mStep = 256.0; // samples per decimated envelope value
+
+  // tracker thread only
+  std::vector<float> mEnvelope, mLinear; // ring, and the ring unrolled oldest first
+  int mWrite = 0, mFilled = 0, mSinceUpdate = 0;
+  float mPending = 0.f;
+  int mPendingCount = 0;
+  uint64_t mNewestTime = 0;
+
+  void drain() {
+    EnvelopeSample sample;
+    while (mQueue.pop(sample)) {
+      mPending += sample.flux;
+      if (++mPendingCount < kDecimation) { continue; }
+      mEnvelope[mWrite] = mPending / kDecimation;
+      mWrite = (mWrite + 1) % kLength;
+      mFilled = std::min(mFilled + 1, kLength);
+      mNewestTime = sample.sampleTime;
+      mPending = 0.f;
+      mPendingCount = 0;
+      if (++mSinceUpdate >= kUpdateEvery && mFilled == kLength) {
+        mSinceUpdate = 0;
+        analyze();
+      }
+    }
+  }
+
+  void analyze() {
+    // unroll, remove the mean so the autocorrelation measures periodicity
+    float mean = 0.f;
+    for (int i = 0; i < kLength; i++) {
+      mLinear[i] = mEnvelope[(mWrite + i) % kLength];
+      mean += mLinear[i];
+    }
+    mean /= kLength;
+    for (auto& x : mLinear) { x -= mean; }
+
+    const double rate = mSampleRate / mStep; // decimated envelope values per second
+    const int minLag = std::max(2, int(std::floor(rate * 60.0 / maxBpm)));
+    const int maxLag = std::min(kLength / 2, int(std::ceil(rate * 60.0 / minBpm)));
+
+    float energy = 0.f;
+    for (int i = 0; i < kLength; i++) { energy += mLinear[i] * mLinear[i]; }
+    if (energy <= 1e-9f) { return; }
+
+    int bestLag = -1;
+    float bestScore = 0.f;
+    float acf[3] = {}; // around the best lag, for interpolation
+    for (int lag = minLag - 1; lag <= maxLag + 1; lag++) {
+      float r = autocorrelation(lag);
+      float bpm = float(60.0 * rate / lag);
+      float octaves = std::log2(bpm / preferredBpm);
+      float score = r * std::exp(-0.5f * octaves * octaves); // prior, 1 octave std dev
+      if (lag >= minLag && lag <= maxLag && score > bestScore) {
+        bestScore = score;
+        bestLag = lag;
+      }
+    }
+    if (bestLag < 0) { return; }
+    acf[0] = autocorrelation(bestLag - 1);
+    acf[1] = autocorrelation(bestLag);
+    acf[2] = autocorrelation(bestLag + 1);
+
+    double offset = 0.0;
+    const float denom = acf[0] - 2.f * acf[1] + acf[2];
+    if (denom < 0.f) { offset = 0.5 * (acf[0] - acf[2]) / denom; }
+    const double lag = bestLag + std::max(-0.5, std::min(0.5, offset));
+
+    // phase: which offset back from "now" lines up best with a comb at this lag
+    int bestPhase = 0;
+    float bestComb = -1e30f;
+    for (int phase = 0; phase < bestLag; phase++) {
+      float comb = 0.f;
+      for (double t = kLength - 1 - phase; t >= 0.0; t -= lag) {
+        comb += mLinear[int(t)];
+      }
+      if (comb > bestComb) {
+        bestComb = comb;
+        bestPhase = phase;
+      }
+    }
+
+    BeatState state;
+    state.period = lag * mStep;
+    state.bpm = float(60.0 * mSampleRate / state.period);
+    state.confidence = std::max(0.f, acf[1] / (energy / kLength));
+    state.confidence = std::min(state.confidence, 1.f);
+    state.lastBeatTime = mNewestTime - uint64_t(bestPhase * mStep);
+    mState.write(state);
+  }
+
+  // normalized by overlap so long lags aren't penalized
+  float autocorrelation(int lag) const {
+    float sum = 0.f;
+    for (int i = lag; i < kLength; i++) { sum += mLinear[i] * mLinear[i - lag]; }
+    return sum / float(kLength - lag);
+  }
+};
+
+#endif // EOYS_BEAT_TRACKER_HPP
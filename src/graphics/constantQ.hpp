@@ -0,0 +1,154 @@
+#ifndef EOYS_CONSTANT_Q_HPP
+#define EOYS_CONSTANT_Q_HPP
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+// Gamma includes
+#include "Gamma/FFT.h"
+#include "Gamma/Types.h"
+
+/**
+ * @brief Spectral kernel for a constant-Q transform (Brown & Puckette 1992).
+ *
+ * Each band k at `minFreq * 2^(k / binsPerOctave)` gets a Hann-windowed complex
+ * sinusoid `Q` cycles long, right-aligned in an FFT frame so every band ends
+ * at the newest sample (low bands lag by half their length, high bands barely
+ * at all). The FFT of each is thresholded to a few nonzero bins, so the CQT of
+ * a frame is one sparse multiply against the frame's FFT.
+ */
+struct ConstantQKernel {
+  struct Entry {
+    int bin;
+    gam::Complex<float> weight; // conjugated and scaled, ready to multiply
+  };
+
+  int fftSize = 0;
+  int numBands = 0;
+  std::vector<float> frequencies;
+  std::vector<std::vector<Entry>> bands;
+
+  ConstantQKernel(float sampleRate, float minFreq, int binsPerOctave, int numBands, float threshold = 0.0054f)
+    : numBands(numBands) {
+    const double q = 1.0 / (std::pow(2.0, 1.0 / binsPerOctave) - 1.0);
+    const int longest = int(std::ceil(q * sampleRate / minFreq));
+    fftSize = 1;
+    while (fftSize < longest) { fftSize <<= 1; }
+
+    gam::CFFT<float> fft(fftSize);
+    std::vector<gam::Complex<float>> temporal(fftSize);
+    for (int k = 0; k < numBands; k++) {
+      const double freq = minFreq * std::pow(2.0, double(k) / binsPerOctave);
+      frequencies.push_back(float(freq));
+      const int length = std::min(fftSize, int(std::ceil(q * sampleRate / freq)));
+
+      std::fill(temporal.begin(), temporal.end(), gam::Complex<float>(0.f, 0.f));
+      for (int n = 0; n < length; n++) {
+        const double window = 0.5 - 0.5 * std::cos(2.0 * M_PI * n / length);
+        const double phase = 2.0 * M_PI * q * n / length;
+        temporal[fftSize - length + n] = gam::Complex<float>(
+          float(window / length * std::cos(phase)), float(window / length * std::sin(phase)));
+      }
+      fft.forward(temporal.data(), false); // unnormalized, so Parseval's sum below holds
+
+      float peak = 0.f;
+      for (auto& c : temporal) { peak = std::max(peak, std::sqrt(c.norm2())); }
+      bands.emplace_back();
+      for (int j = 0; j < fftSize; j++) {
+        if (std::sqrt(temporal[j].norm2()) < threshold * peak) { continue; }
+        // sum_n x[n] conj(k[n]) = (1/N) sum_j X[j] conj(K[j])
+        bands.back().push_back({ j, gam::Complex<float>(temporal[j].r / fftSize, -temporal[j].i / fftSize) });
+      }
+    }
+  }
+
+  /**
+   * @brief One kernel per distinct configuration for the whole process, since
+   * every channel uses the same one. Call outside the audio thread.
+   */
+  static std::shared_ptr<const ConstantQKernel> shared(float sampleRate, float minFreq, int binsPerOctave, int numBands) {
+    static std::map<std::tuple<float, float, int, int>, std::shared_ptr<const ConstantQKernel>> cache;
+    auto key = std::make_tuple(sampleRate, minFreq, binsPerOctave, numBands);
+    auto it = cache.find(key);
+    if (it != cache.end()) { return it->second; }
+    auto kernel = std::make_shared<const ConstantQKernel>(sampleRate, minFreq, binsPerOctave, numBands);
+    cache[key] = kernel;
+    return kernel;
+  }
+};
+
+/**
+ * @brief Streaming constant-Q band magnitudes for one input. Keeps the last
+ * `fftSize` samples; every `hop` samples it does one FFT and one sparse
+ * multiply. Defaults give third-octave bands from 40Hz to about 16kHz.
+ * Buffers are allocated in configure().
+ */
+class ConstantQ {
+public:
+  static constexpr int kDefaultBands = 27;
+
+  void configure(float sampleRate, float minFreq = 40.f, int binsPerOctave = 3,
+                 int numBands = kDefaultBands, int hop = 1024) {
+    mKernel = ConstantQKernel::shared(sampleRate, minFreq, binsPerOctave, numBands);
+    mFft.reset(new gam::CFFT<float>(mKernel->fftSize));
+    mInput.assign(mKernel->fftSize, 0.f);
+    mSpectrum.assign(mKernel->fftSize, gam::Complex<float>(0.f, 0.f));
+    mMagnitudes.assign(numBands, 0.f);
+    mHop = hop;
+    mWrite = 0;
+    mSinceHop = 0;
+  }
+
+  // call per input sample, returns true when new magnitudes are ready
+  bool process(float inputSample) {
+    if (!mKernel) { return false; }
+    mInput[mWrite] = inputSample;
+    mWrite = (mWrite + 1) % mKernel->fftSize;
+    if (++mSinceHop < mHop) { return false; }
+    mSinceHop = 0;
+
+    const int n = mKernel->fftSize;
+    for (int i = 0; i < n; i++) {
+      mSpectrum[i] = gam::Complex<float>(mInput[(mWrite + i) % n], 0.f); // oldest first
+    }
+    mFft->forward(mSpectrum.data(), false);
+    for (int k = 0; k < mKernel->numBands; k++) {
+      float re = 0.f, im = 0.f;
+      for (const auto& entry : mKernel->bands[k]) {
+        const gam::Complex<float>& x = mSpectrum[entry.bin];
+        re += x.r * entry.weight.r - x.i * entry.weight.i;
+        im += x.r * entry.weight.i + x.i * entry.weight.r;
+      }
+      mMagnitudes[k] = std::sqrt(re * re + im * im);
+    }
+    return true;
+  }
+
+  int numBands() const {
+    return mKernel ? mKernel->numBands : 0;
+  }
+
+  // linear magnitude per band, a full-scale sine reads about 0.25
+  const std::vector<float>& magnitudes() const {
+    return mMagnitudes;
+  }
+
+  float frequency(int band) const {
+    return mKernel->frequencies[band];
+  }
+
+private:
+  std::shared_ptr<const ConstantQKernel> mKernel;
+  std::unique_ptr<gam::CFFT<float>> mFft;
+  std::vector<float> mInput;
+  std::vector<gam::Complex<float>> mSpectrum;
+  std::vector<float> mMagnitudes;
+  int mHop = 1024, mWrite = 0, mSinceHop = 0;
+};
+
+#endif // EOYS_CONSTANT_Q_HPP
@@ -0,0 +1,204 @@
+#ifndef EOYS_DRUM_TRIGGERS_HPP
+#define EOYS_DRUM_TRIGGERS_HPP
+
+// std includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// al includes
+#include "al/io/al_AudioIOData.hpp"
+
+// eoys includes
+#include "audioReactor.hpp"
+
+/**
+ * @brief Latest hit on one drum, for readers that only poll once a frame.
+ */
+struct DrumState {
+  uint32_t hits = 0; // hits so far, compare against the last value seen
+  uint64_t lastHitTime = 0; // input sample the hit started on
+  float velocity = 0.f; // peak input level of the hit, 0..1
+};
+
+/**
+ * @brief Envelope-follower transient detector for one close drum mic.
+ *
+ * A fast peak envelope (instant attack, ~5ms release) is compared against a
+ * slow one (~100ms) that tracks bleed and ring. A hit starts when the fast
+ * envelope is over `threshold` and `ratio` times the slow one, then its peak
+ * is measured over the next `peakWindow` samples (~1.5ms) to give a velocity.
+ * Nothing retriggers until `holdOff` samples after the hit started.
+ *
+ * A few multiply-adds per sample and no buffers, so it runs in the audio callback.
+ */
+class TransientDetector {
+public:
+  float threshold = 0.1f;
+  float ratio = 2.f;
+  unsigned holdOff = 2646; // samples, 60ms at 44.1kHz
+  unsigned peakWindow = 66; // samples, 1.5ms at 44.1kHz
+
+  void setSampleRate(float sampleRate, float holdOffMs) {
+    holdOff = unsigned(holdOffMs * 0.001f * sampleRate);
+    peakWindow = std::max(1u, unsigned(0.0015f * sampleRate));
+    mFastRelease = std::exp(-1.f / (0.005f * sampleRate));
+    mSlowCoeff = 1.f - std::exp(-1.f / (0.1f * sampleRate));
+  }
+
+  /**
+   * @brief Call per input sample. Returns true once a hit's peak is known,
+   * then `velocity` is set and `delay` is how many samples ago it started.
+   */
+  bool process(float inputSample, float& velocity, unsigned& delay) {
+    const float level = std::fabs(inputSample);
+    mFast = level > mFast ? level : mFast * mFastRelease;
+    mSlow += mSlowCoeff * (level - mSlow);
+
+    if (mSinceHit < holdOff) { mSinceHit++; }
+    if (mMeasuring > 0) {
+      mPeak = std::max(mPeak, mFast);
+      if (--mMeasuring == 0) {
+        velocity = std::min(1.f, mPeak);
+        delay = peakWindow;
+        return true;
+      }
+      return false;
+    }
+    if (mSinceHit >= holdOff && mFast > threshold && mFast > ratio * mSlow) {
+      mMeasuring = peakWindow;
+      mPeak = mFast;
+      mSinceHit = 0;
+    }
+    return false;
+  }
+
+private:
+  float mFast = 0.f, mSlow = 0.f, mPeak = 0.f;
+  float mFastRelease = 0.99547f, mSlowCoeff = 0.000227f; // 44.1kHz until setSampleRate()
+  unsigned mMeasuring = 0;
+  unsigned mSinceHit = ~0u >> 1;
+};
+
+/**
+ * @brief Hit detection on the individual drum mics, straight from the audio
+ * callback with no FFT, so visuals can react within a block of the stick
+ * landing.
+ *
+ * Register drums with addDrum() before audio starts. process() runs one
+ * TransientDetector per drum and publishes each hit per drum through a
+ * FrameReporter (see latest()) for any number of readers. Sample times count
+ * the same input samples as AnalysisBus::sampleTime().
+ */
+class DrumTriggerBus {
+public:
+  void setSampleRate(float sampleRate) {
+    mSampleRate = sampleRate;
+    for (auto& drum : mDrums) { drum->detector.setSampleRate(sampleRate, drum->holdOffMs); }
+  }
+
+  /**
+   * @brief Watches `inputChannel` for hits louder than `threshold` (linear
+   * peak), at most one per `holdOffMs`. Returns the drum's index, or -1 if the
+   * bus is full. Call before audio starts.
+   */
+  int addDrum(const std::string& name, unsigned inputChannel, float threshold, float holdOffMs = 60.f) {
+    if (mDrums.size() >= kMaxDrums) {
+      std::cerr << "DrumTriggerBus Error: No room for drum " << name << std::endl;
+      return -1;
+    }
+    mDrums.push_back(std::make_unique<Drum>());
+    Drum& drum = *mDrums.back();
+    drum.name = name;
+    drum.inputChannel = inputChannel;
+    drum.holdOffMs = holdOffMs;
+    drum.threshold.store(threshold);
+    drum.detector.setSampleRate(mSampleRate, holdOffMs);
+    return int(mDrums.size()) - 1;
+  }
+
+  // index of the drum called `name`, or -1
+  int find(const std::string& name) const {
+    for (size_t i = 0; i < mDrums.size(); i++) {
+      if (mDrums[i]->name == name) { return int(i); }
+    }
+    return -1;
+  }
+
+  unsigned numDrums() const {
+    return unsigned(mDrums.size());
+  }
+
+  // safe to call while audio runs, e.g. from a GUI
+  void setThreshold(unsigned drum, float threshold) {
+    if (drum < mDrums.size()) { mDrums[drum]->threshold.store(threshold, std::memory_order_relaxed); }
+  }
+
+  // latest hit on `drum`, zeroed if it hasn't been hit yet
+  DrumState latest(unsigned drum) const {
+    if (drum >= mDrums.size()) { return DrumState(); }
+    return mDrums[drum]->reporter.reportValue();
+  }
+
+  float sampleRate() const {
+    return mSampleRate;
+  }
+
+  // input samples received so far
+  uint64_t sampleTime() const {
+    return mSampleTime.load(std::memory_order_relaxed);
+  }
+
+  // audio thread
+  void process(al::AudioIOData& io) {
+    const unsigned frames = io.framesPerBuffer();
+    const uint64_t blockStart = mSampleTime.load(std::memory_order_relaxed);
+    for (size_t d = 0; d < mDrums.size(); d++) {
+      Drum& drum = *mDrums[d];
+      if (drum.inputChannel >= unsigned(io.channelsIn())) { continue; }
+      drum.detector.threshold = drum.threshold.load(std::memory_order_relaxed);
+      for (unsigned i = 0; i < frames; i++) {
+        float velocity;
+        unsigned delay;
+        if (!drum.detector.process(io.in(drum.inputChannel, i), velocity, delay)) { continue; }
+        drum.state.hits++;
+        drum.state.lastHitTime = blockStart + i - std::min<uint64_t>(blockStart + i, delay);
+        drum.state.velocity = velocity;
+        drum.reporter.write(drum.state);
+      }
+    }
+    mSampleTime.store(blockStart + frames, std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr size_t kMaxDrums = 16;
+
+  struct Drum {
+    std::string name;
+    unsigned inputChannel = 0;
+    float holdOffMs = 60.f;
+    std::atomic<float> threshold { 0.1f };
+    TransientDetector detector;
+    DrumState state; // audio thread's copy
+    FrameReporter<DrumState> reporter;
+  };
+
+  std::vector<std::unique_ptr<Drum>> mDrums;
+  std::atomic<uint64_t> mSampleTime { 0 };
+  float mSampleRate = 44100.f;
+};
+
+/**
+ * @brief The process-wide trigger bus, fed by AudioManager and read by voices.
+ */
+inline DrumTriggerBus& drumTriggers() {
+  static DrumTriggerBus bus;
+  return bus;
+}
+
+#endif // EOYS_DRUM_TRIGGERS_HPP
@@ -0,0 +1,213 @@
+#ifndef EOYS_FEATURE_EXTRACTOR_HPP
+#define EOYS_FEATURE_EXTRACTOR_HPP
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+/**
+ * @brief Latest analysis results for one input channel. Fixed layout,
+ * so it can be copied between threads without allocating.
+ */
+struct FeatureFrame {
+  static constexpr int kMaxBands = 8;
+  static constexpr int kMaxConstantQBands = 32;
+
+  uint64_t sampleTime = 0; // input sample count at the end of this frame's hop
+  float rms = 0.f; // windowed, see WindowedRms
+  float centroid = 0.f; // Hz
+  float flux = 0.f; // positive spectral flux
+  float rolloff = 0.f; // Hz below which `rolloffFraction` of the energy sits
+  float flatness = 0.f; // 0 tonal .. 1 noisy
+  float crest = 0.f; // peak / mean magnitude
+  float bands[kMaxBands] = {}; // energy per band, see FeatureExtractor::setBands()
+  float constantQ[kMaxConstantQBands] = {}; // third-octave magnitudes from 40Hz, see ConstantQ
+  float pitch = 0.f; // Hz, 0 if unvoiced or not tracked, see PitchTracker
+  float pitchConfidence = 0.f;
+  uint32_t onsets = 0; // running count, compare against the last count you saw
+  uint64_t lastOnsetTime = 0; // sample time of the latest onset, see OnsetDetector
+};
+
+/**
+ * @brief RMS over the last `size` samples. Keeps a running sum of squares
+ * in a ring, recomputed from scratch once per lap so float error can't drift.
+ */
+class WindowedRms {
+public:
+  explicit WindowedRms(int size = 1024) { resize(size); }
+
+  void resize(int size) {
+    mSquares.assign(std::max(size, 1), 0.f);
+    reset();
+  }
+
+  void reset() {
+    std::fill(mSquares.begin(), mSquares.end(), 0.f);
+    mSum = 0.0;
+    mIndex = 0;
+  }
+
+  void process(float sample) {
+    float square = sample * sample;
+    mSum += square - mSquares[mIndex];
+    mSquares[mIndex] = square;
+    if (++mIndex == int(mSquares.size())) {
+      mIndex = 0;
+      mSum = 0.0;
+      for (float s : mSquares) { mSum += s; }
+    }
+  }
+
+  float rms() const {
+    return std::sqrt(float(std::max(mSum, 0.0) / mSquares.size()));
+  }
+
+private:
+  std::vector<float> mSquares;
+  double mSum = 0.0;
+  int mIndex = 0;
+};
+
+/**
+ * @brief Spectral features from a magnitude spectrum in one pass per hop:
+ * centroid, positive flux, flatness and crest, then band energies and rolloff
+ * from the power kept during that pass.
+ *
+ * The bin loop runs over fixed-width lanes of independent accumulators and
+ * takes logs with a bit-trick approximation, so the compiler can vectorize it
+ * (no calls, no branches, no cross-iteration dependency). Everything is sized
+ * in configure(); process() never allocates.
+ */
+class FeatureExtractor {
+public:
+  static constexpr int kLanes = 8;
+  float rolloffFraction = 0.85f;
+
+  /**
+   * @param numBins Bins per spectrum, e.g. `stft.numBins()`
+   * @param binFreq Hz per bin, e.g. `stft.binFreq()`
+   */
+  void configure(int numBins, float binFreq) {
+    mNumBins = numBins;
+    mBinFreq = binFreq;
+    int padded = (numBins + kLanes - 1) / kLanes * kLanes; // zero tail, no remainder loop
+    mPrev.assign(padded, 0.f);
+    mMags.assign(padded, 0.f);
+    mFreqs.assign(padded, 0.f);
+    mPower.assign(padded, 0.f);
+    for (int i = 0; i < numBins; i++) { mFreqs[i] = i * binFreq; }
+    mHasPrev = false;
+    setBands({ 60.f, 150.f, 400.f, 1000.f, 2500.f, 5000.f, 10000.f });
+  }
+
+  /**
+   * @brief Sets band edges in Hz between 0 and Nyquist, up to
+   * `FeatureFrame::kMaxBands - 1` edges. Call outside the audio thread.
+   */
+  void setBands(const std::vector<float>& edgesHz) {
+    mBandStart.clear();
+    mBandStart.push_back(0);
+    for (float edge : edgesHz) {
+      if (int(mBandStart.size()) == FeatureFrame::kMaxBands) { break; }
+      int bin = std::min(mNumBins, int(std::ceil(edge / mBinFreq)));
+      mBandStart.push_back(std::max(bin, mBandStart.back()));
+    }
+    mBandStart.push_back(mNumBins);
+  }
+
+  int numBands() const {
+    return int(mBandStart.size()) - 1;
+  }
+
+  // fills the spectral fields of `out`, leaves rms / onsets / sampleTime alone
+  void process(const float* magnitudes, FeatureFrame& out) {
+    std::memcpy(mMags.data(), magnitudes, mNumBins * sizeof(float));
+
+    float weighted[kLanes] = {}, magSum[kLanes] = {}, flux[kLanes] = {};
+    float logSum[kLanes] = {}, peak[kLanes] = {}, powerSum[kLanes] = {};
+    const float* mags = mMags.data();
+    const float* freqs = mFreqs.data();
+    float* prev = mPrev.data();
+    float* power = mPower.data();
+    const int size = int(mMags.size());
+
+    for (int i = 0; i < size; i += kLanes) {
+      for (int l = 0; l < kLanes; l++) {
+        const float m = mags[i + l];
+        const float p = m * m;
+        weighted[l] += freqs[i + l] * m;
+        magSum[l] += m;
+        flux[l] += std::max(m - prev[i + l], 0.f);
+        logSum[l] += fastLog2(p + kFloor);
+        peak[l] = std::max(peak[l], m);
+        powerSum[l] += p;
+        power[i + l] = p;
+        prev[i + l] = m;
+      }
+    }
+
+    const float totalMag = sumLanes(magSum);
+    const float totalPower = sumLanes(powerSum);
+    const float n = float(mNumBins);
+    float peakMag = 0.f;
+    for (int l = 0; l < kLanes; l++) { peakMag = std::max(peakMag, peak[l]); }
+
+    out.centroid = totalMag > 0.f ? sumLanes(weighted) / totalMag : 0.f;
+    out.flux = mHasPrev ? sumLanes(flux) : 0.f;
+    out.crest = totalMag > 0.f ? peakMag / (totalMag / n) : 0.f;
+    // padded bins add log2(kFloor) each, take them back out
+    const float padLog = float(size - mNumBins) * fastLog2(kFloor);
+    const float geoMean = std::exp2((sumLanes(logSum) - padLog) / n);
+    out.flatness = totalPower > 0.f ? std::min(geoMean / (totalPower / n), 1.f) : 0.f;
+    mHasPrev = true;
+
+    // bands and rolloff read back the power stored above, still in cache
+    for (int b = 0; b < FeatureFrame::kMaxBands; b++) {
+      out.bands[b] = b < numBands() ? std::accumulate(power + mBandStart[b], power + mBandStart[b + 1], 0.f) : 0.f;
+    }
+    out.rolloff = rolloff(totalPower);
+  }
+
+private:
+  int mNumBins = 0;
+  float mBinFreq = 1.f;
+  bool mHasPrev = false;
+  std::vector<float> mPrev, mMags, mFreqs, mPower;
+  std::vector<int> mBandStart;
+
+  static constexpr float kFloor = 1e-12f; // keeps log2 of silent bins finite
+
+  static float sumLanes(const float* lanes) {
+    float sum = 0.f;
+    for (int l = 0; l < kLanes; l++) { sum += lanes[l]; }
+    return sum;
+  }
+
+  // log2 to within 0.02, good enough for a geometric mean
+  static float fastLog2(float x) {
+    int32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    const float exponent = float(((bits >> 23) & 255) - 128); // one low, the poly adds it back
+    bits = (bits & ~(255 << 23)) | (127 << 23); // mantissa in [1, 2)
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+    return exponent + (-0.34484843f * m + 2.02466578f) * m - 0.65871759f; // poly is log2(m) + 1
+  }
+
+  // scalar, but it stops as soon as it crosses the threshold
+  float rolloff(float totalPower) const {
+    const float target = rolloffFraction * totalPower;
+    float cumulative = 0.f;
+    for (int i = 0; i < mNumBins; i++) {
+      cumulative += mPower[i];
+      if (cumulative >= target) { return i * mBinFreq; }
+    }
+    return (mNumBins - 1) * mBinFreq;
+  }
+};
+
+#endif // EOYS_FEATURE_EXTRACTOR_HPP
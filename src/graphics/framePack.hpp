@@ -0,0 +1,272 @@
+#ifndef EOYS_FRAME_PACK_HPP
+#define EOYS_FRAME_PACK_HPP
+
+// std includes
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief On-disk layout of a frame pack: a video decoded once, offline (see
+ * src/tools/bakeFramePacks.cpp), so playback is a memory map instead of H.264.
+ *
+ * Header, then the frames, then one FramePackEntry per frame at `indexOffset`.
+ * Each frame is `height` rows of `stride` bytes, in the channel order OpenCV
+ * decodes to (BGR or BGRA), starting on a page boundary. Readers only accept
+ * tightly packed rows, `stride == width * channels`. Host byte order: bake on
+ * the same kind of machine that plays it.
+ */
+struct FramePackHeader {
+  static constexpr uint32_t kVersion = 1;
+  static constexpr uint32_t kPageSize = 4096;
+
+  char magic[8] = { 'E', 'O', 'Y', 'S', 'P', 'A', 'C', 'K' };
+  uint32_t version = kVersion;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t channels = 0; // 3 = BGR, 4 = BGRA
+  uint32_t stride = 0; // bytes per row
+  uint32_t frameCount = 0;
+  double frameRate = 30.0;
+  uint64_t frameBytes = 0; // stride * height
+  uint64_t indexOffset = 0; // first FramePackEntry
+
+  bool valid() const {
+    return std::memcmp(magic, FramePackHeader().magic, sizeof(magic)) == 0 && version == kVersion;
+  }
+};
+
+struct FramePackEntry {
+  uint64_t offset = 0; // from the start of the file
+  uint64_t bytes = 0;
+};
+
+/**
+ * @brief Writes a frame pack one frame at a time. The pack only appears at
+ * `path` once finish() succeeds, so a cancelled bake never leaves a half file.
+ */
+class FramePackWriter {
+public:
+  ~FramePackWriter() {
+    if (mFile.is_open()) { // never finished
+      mFile.close();
+      std::remove(mTempPath.c_str());
+    }
+  }
+
+  bool open(const std::string& path, int width, int height, int channels, double frameRate) {
+    mPath = path;
+    mTempPath = path + ".tmp";
+    mFile.open(mTempPath, std::ios::binary | std::ios::trunc);
+    if (!mFile) {
+      std::cerr << "FramePackWriter Error: Could not create " << mTempPath << std::endl;
+      return false;
+    }
+    mHeader = FramePackHeader();
+    mHeader.width = uint32_t(width);
+    mHeader.height = uint32_t(height);
+    mHeader.channels = uint32_t(channels);
+    mHeader.stride = uint32_t(width * channels);
+    mHeader.frameRate = frameRate;
+    mHeader.frameBytes = uint64_t(mHeader.stride) * uint64_t(height);
+    mEntries.clear();
+    mFile.write(reinterpret_cast<const char*>(&mHeader), sizeof(mHeader)); // rewritten by finish()
+    return bool(mFile);
+  }
+
+  // `rows` of `stride` bytes each, padding past the pixels is dropped
+  bool write(const uint8_t* pixels, size_t stride) {
+    pad();
+    FramePackEntry entry;
+    entry.offset = uint64_t(mFile.tellp());
+    entry.bytes = mHeader.frameBytes;
+    for (uint32_t row = 0; row < mHeader.height; row++) {
+      mFile.write(reinterpret_cast<const char*>(pixels + row * stride), mHeader.stride);
+    }
+    if (!mFile) {
+      std::cerr << "FramePackWriter Error: Write failed at frame " << mEntries.size() << std::endl;
+      return false;
+    }
+    mEntries.push_back(entry);
+    return true;
+  }
+
+  bool finish() {
+    mHeader.frameCount = uint32_t(mEntries.size());
+    pad();
+    mHeader.indexOffset = uint64_t(mFile.tellp());
+    mFile.write(reinterpret_cast<const char*>(mEntries.data()), mEntries.size() * sizeof(FramePackEntry));
+    mFile.seekp(0);
+    mFile.write(reinterpret_cast<const char*>(&mHeader), sizeof(mHeader));
+    mFile.close();
+    if (!mFile || std::rename(mTempPath.c_str(), mPath.c_str()) != 0) {
+      std::cerr << "FramePackWriter Error: Could not finish " << mPath << std::endl;
+      std::remove(mTempPath.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  size_t framesWritten() const {
+    return mEntries.size();
+  }
+
+private:
+  std::string mPath, mTempPath;
+  std::ofstream mFile;
+  FramePackHeader mHeader;
+  std::vector<FramePackEntry> mEntries;
+
+  // frames start on a page so they map cleanly
+  void pad() {
+    const uint64_t position = uint64_t(mFile.tellp());
+    const uint64_t aligned = (position + FramePackHeader::kPageSize - 1) / FramePackHeader::kPageSize * FramePackHeader::kPageSize;
+    static const char zeros[FramePackHeader::kPageSize] = {};
+    mFile.write(zeros, std::streamsize(aligned - position));
+  }
+};
+
+/**
+ * @brief Read-only memory map of a frame pack. frame() points straight into
+ * the page cache: nothing is decoded or copied, and any frame can be reached
+ * directly. prefetch() asks the kernel to page in frames before they're needed.
+ */
+class FramePack {
+public:
+  ~FramePack() {
+    close();
+  }
+
+  // the pack the bake tool writes for `videoPath`: same name, .pack extension
+  static std::string packPathFor(const std::string& videoPath) {
+    const size_t dot = videoPath.find_last_of('.');
+    const size_t slash = videoPath.find_last_of("/\\");
+    const bool hasExtension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+    return (hasExtension ? videoPath.substr(0, dot) : videoPath) + ".pack";
+  }
+
+  static bool exists(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return bool(file);
+  }
+
+  // true if `packPath` exists and is no older than `videoPath` (or the video is gone, the pack is all there is)
+  static bool upToDate(const std::string& videoPath, const std::string& packPath) {
+#if defined(_WIN32)
+    return exists(packPath);
+#else
+    struct stat videoInfo, packInfo;
+    if (stat(packPath.c_str(), &packInfo) != 0) { return false; }
+    if (stat(videoPath.c_str(), &videoInfo) != 0) { return true; }
+    return packInfo.st_mtime >= videoInfo.st_mtime;
+#endif
+  }
+
+  bool open(const std::string& path) {
+    close();
+#if defined(_WIN32)
+    std::cerr << "FramePack Error: Memory-mapped packs aren't supported on Windows yet" << std::endl;
+    return false;
+#else
+    mFd = ::open(path.c_str(), O_RDONLY);
+    if (mFd < 0) {
+      std::cerr << "FramePack Error: Could not open " << path << std::endl;
+      return false;
+    }
+    struct stat info;
+    if (fstat(mFd, &info) != 0 || size_t(info.st_size) < sizeof(FramePackHeader)) {
+      std::cerr << "FramePack Error: " << path << " is too small to be a pack" << std::endl;
+      close();
+      return false;
+    }
+    mSize = size_t(info.st_size);
+    void* data = mmap(nullptr, mSize, PROT_READ, MAP_SHARED, mFd, 0);
+    if (data == MAP_FAILED) {
+      std::cerr << "FramePack Error: Could not map " << path << std::endl;
+      mSize = 0;
+      close();
+      return false;
+    }
+    mData = static_cast<const uint8_t*>(data);
+    std::memcpy(&mHeader, mData, sizeof(mHeader));
+    const uint64_t indexEnd = mHeader.indexOffset + uint64_t(mHeader.frameCount) * sizeof(FramePackEntry);
+    if (!mHeader.valid() || mHeader.frameCount == 0 || indexEnd > mSize) {
+      std::cerr << "FramePack Error: " << path << " is not a version " << FramePackHeader::kVersion << " pack" << std::endl;
+      close();
+      return false;
+    }
+    // playback copies and uploads rows `width * channels` apart, so padded rows aren't supported
+    const uint64_t rowBytes = uint64_t(mHeader.width) * uint64_t(mHeader.channels);
+    if ((mHeader.channels != 3 && mHeader.channels != 4) || mHeader.width == 0 || mHeader.height == 0 ||
+        mHeader.stride != rowBytes || mHeader.frameBytes != rowBytes * uint64_t(mHeader.height)) {
+      std::cerr << "FramePack Error: " << path << " has an unsupported frame layout (" << mHeader.width << "x"
+                << mHeader.height << ", " << mHeader.channels << " channels, stride " << mHeader.stride << ")" << std::endl;
+      close();
+      return false;
+    }
+    mEntries = reinterpret_cast<const FramePackEntry*>(mData + mHeader.indexOffset);
+    for (uint32_t i = 0; i < mHeader.frameCount; i++) {
+      if (mEntries[i].offset + mEntries[i].bytes > mSize || mEntries[i].bytes < mHeader.frameBytes) {
+        std::cerr << "FramePack Error: " << path << " is truncated at frame " << i << std::endl;
+        close();
+        return false;
+      }
+    }
+    return true;
+#endif
+  }
+
+  void close() {
+#if !defined(_WIN32)
+    if (mData) { munmap(const_cast<uint8_t*>(mData), mSize); }
+    if (mFd >= 0) { ::close(mFd); }
+#endif
+    mData = nullptr;
+    mEntries = nullptr;
+    mSize = 0;
+    mFd = -1;
+  }
+
+  bool isOpen() const { return mData != nullptr; }
+  const FramePackHeader& header() const { return mHeader; }
+  int width() const { return int(mHeader.width); }
+  int height() const { return int(mHeader.height); }
+  int channels() const { return int(mHeader.channels); }
+  int frameCount() const { return int(mHeader.frameCount); }
+  double frameRate() const { return mHeader.frameRate; }
+
+  // pixels of `index`, valid until close()
+  const uint8_t* frame(int index) const {
+    return mData + mEntries[index].offset;
+  }
+
+  // hint that frames [index, index + count) are needed soon, wrapping at the end
+  void prefetch(int index, int count) const {
+#if !defined(_WIN32)
+    for (int i = 0; i < count; i++) {
+      const FramePackEntry& entry = mEntries[(index + i) % frameCount()];
+      madvise(const_cast<uint8_t*>(mData + entry.offset), entry.bytes, MADV_WILLNEED);
+    }
+#endif
+  }
+
+private:
+  const uint8_t* mData = nullptr;
+  const FramePackEntry* mEntries = nullptr;
+  size_t mSize = 0;
+  int mFd = -1;
+  FramePackHeader mHeader;
+};
+
+#endif // EOYS_FRAME_PACK_HPP
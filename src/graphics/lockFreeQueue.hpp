@@ -0,0 +1,79 @@
+#ifndef EOYS_LOCK_FREE_QUEUE_HPP
+#define EOYS_LOCK_FREE_QUEUE_HPP
+
+// std includes
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Bounded single-producer single-consumer queue. Never blocks and never
+ * allocates after construction; push() fails instead of overwriting when full.
+ * Use it to get events off the audio thread (one thread pushes, one pops).
+ */
+template <class T>
+class SpscQueue {
+public:
+  // capacity is rounded up to a power of two
+  explicit SpscQueue(size_t capacity = 256) {
+    size_t size = 2;
+    while (size < capacity) { size <<= 1; }
+    mSlots.resize(size);
+    mMask = size - 1;
+  }
+
+  // producer
+  bool push(const T& value) {
+    const size_t head = mHead.load(std::memory_order_relaxed);
+    if (head - mTail.load(std::memory_order_acquire) > mMask) { return false; } // full
+    mSlots[head & mMask] = value;
+    mHead.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer
+  bool pop(T& value) {
+    const size_t tail = mTail.load(std::memory_order_relaxed);
+    if (tail == mHead.load(std::memory_order_acquire)) { return false; } // empty
+    value = mSlots[tail & mMask];
+    mTail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief In-place variants, for big elements that shouldn't be copied twice.
+   * writeSlot() returns null when full; fill the slot, then commitWrite().
+   */
+  T* writeSlot() {
+    const size_t head = mHead.load(std::memory_order_relaxed);
+    if (head - mTail.load(std::memory_order_acquire) > mMask) { return nullptr; }
+    return &mSlots[head & mMask];
+  }
+
+  void commitWrite() {
+    mHead.store(mHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  // null when empty; use the slot, then commitRead()
+  const T* readSlot() {
+    const size_t tail = mTail.load(std::memory_order_relaxed);
+    if (tail == mHead.load(std::memory_order_acquire)) { return nullptr; }
+    return &mSlots[tail & mMask];
+  }
+
+  void commitRead() {
+    mTail.store(mTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  size_t capacity() const {
+    return mMask + 1;
+  }
+
+private:
+  std::vector<T> mSlots;
+  size_t mMask = 0;
+  alignas(64) std::atomic<size_t> mHead { 0 }; // written by the producer
+  alignas(64) std::atomic<size_t> mTail { 0 }; // written by the consumer
+};
+
+#endif // EOYS_LOCK_FREE_QUEUE_HPP
@@ -0,0 +1,65 @@
+#ifndef EOYS_LOG_SPECTRUM_HPP
+#define EOYS_LOG_SPECTRUM_HPP
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief A whole spectrum and a slice of waveform for one input channel, for
+ * shaders (see AudioTextures). Fixed layout, so it fits in a FrameReporter.
+ */
+struct SpectrumFrame {
+  static constexpr int kBins = 64;
+  static constexpr int kWaveform = 128;
+
+  uint64_t sampleTime = 0;
+  float spectrum[kBins] = {}; // 0..1, log-frequency, smoothed
+  float waveform[kWaveform] = {}; // -1..1, the last 512 samples decimated by 4
+};
+
+/**
+ * @brief Folds a linear STFT magnitude spectrum into `SpectrumFrame::kBins`
+ * log-spaced bands (30Hz - 16kHz), in dB mapped to 0..1, with a fast attack
+ * and slow release so the visuals don't flicker. Sized in configure().
+ */
+class LogSpectrum {
+public:
+  float minFreq = 30.f, maxFreq = 16000.f;
+  float floorDb = -80.f; // maps to 0, 0dB maps to 1
+  float attack = 0.6f, release = 0.15f; // per hop
+
+  void configure(int numBins, float binFreq) {
+    mStart.assign(SpectrumFrame::kBins + 1, 0);
+    const float ratio = std::log(maxFreq / minFreq);
+    for (int b = 0; b <= SpectrumFrame::kBins; b++) {
+      float freq = minFreq * std::exp(ratio * b / SpectrumFrame::kBins);
+      mStart[b] = std::min(numBins - 1, int(freq / binFreq));
+    }
+    for (int b = 1; b <= SpectrumFrame::kBins; b++) { // at least one bin each
+      mStart[b] = std::max(mStart[b], std::min(numBins, mStart[b - 1] + 1));
+    }
+    std::fill(mSmoothed, mSmoothed + SpectrumFrame::kBins, 0.f);
+  }
+
+  void process(const float* magnitudes, float* out) {
+    for (int b = 0; b < SpectrumFrame::kBins; b++) {
+      float sum = 0.f;
+      for (int k = mStart[b]; k < mStart[b + 1]; k++) { sum += magnitudes[k]; }
+      const float mean = sum / float(std::max(1, mStart[b + 1] - mStart[b]));
+      const float db = 20.f * std::log10(mean + 1e-9f);
+      const float target = std::min(1.f, std::max(0.f, (db - floorDb) / -floorDb));
+      float& value = mSmoothed[b];
+      value += (target > value ? attack : release) * (target - value);
+      out[b] = value;
+    }
+  }
+
+private:
+  std::vector<int> mStart; // first linear bin of each band, plus the end
+  float mSmoothed[SpectrumFrame::kBins] = {};
+};
+
+#endif // EOYS_LOG_SPECTRUM_HPP
@@ -0,0 +1,119 @@
+#ifndef EOYS_ONSET_DETECTOR_HPP
+#define EOYS_ONSET_DETECTOR_HPP
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Gamma includes
+#include "Gamma/DFT.h"
+
+/**
+ * @brief One detected onset.
+ */
+struct OnsetEvent {
+  uint64_t sampleTime = 0; // input sample count at the onset
+  float strength = 0.f; // flux above the threshold
+};
+
+/**
+ * @brief Spectral-flux onset detector with an adaptive median threshold.
+ *
+ * Runs its own small STFT (512 window, 128 hop, about 3ms at 44.1kHz). It takes
+ * the positive flux of log-compressed magnitudes every hop, and picks a peak
+ * when the flux is a local maximum above `median(recent flux) * multiplier + delta`.
+ * Peaks closer than `minInterval` to the previous onset are dropped, so a hit
+ * fires once. That costs one hop of latency, because a peak is only known to be
+ * a peak one hop later.
+ *
+ * Buffers are allocated in the constructor; process() is audio-thread safe.
+ */
+class OnsetDetector {
+public:
+  float multiplier = 1.5f;
+  float delta = 0.5f; // absolute floor so silence never triggers
+  float compression = 100.f; // log(1 + compression * magnitude)
+  unsigned minInterval = 2205; // samples, 50ms at 44.1kHz until setSampleRate()
+
+  static constexpr unsigned kWindow = 512;
+  static constexpr unsigned kHop = 128;
+  static constexpr unsigned kMedianLength = 32; // hops, about 90ms
+
+  OnsetDetector() : stft(kWindow, kHop, 0, gam::HANN) {
+    stft.numAux(1);
+    unsigned bins = stft.numBins();
+    mPrev.assign(bins, 0.f);
+    mHistory.assign(kMedianLength, 0.f);
+    mScratch.assign(kMedianLength, 0.f);
+  }
+
+  void setSampleRate(float sampleRate, float minIntervalMs = 50.f) {
+    minInterval = unsigned(minIntervalMs * 0.001f * sampleRate);
+  }
+
+  /**
+   * @brief Call per input sample. `sampleTime` is this sample's index in the
+   * input stream. Returns true if an onset was picked, then `event` is filled.
+   */
+  bool process(float inputSample, uint64_t sampleTime, OnsetEvent& event) {
+    mHopped = stft(inputSample);
+    if (!mHopped) { return false; }
+    stft.spctToPolar();
+    stft.copyBinsToAux(0, 0);
+    const float* mags = stft.aux(0);
+
+    float flux = 0.f;
+    for (unsigned k = 0; k < mPrev.size(); k++) {
+      const float m = std::log1p(compression * mags[k]);
+      flux += std::max(m - mPrev[k], 0.f);
+      mPrev[k] = m;
+    }
+
+    // threshold from the flux history, not counting this hop
+    std::copy(mHistory.begin(), mHistory.end(), mScratch.begin());
+    std::nth_element(mScratch.begin(), mScratch.begin() + kMedianLength / 2, mScratch.end());
+    const float threshold = mScratch[kMedianLength / 2] * multiplier + delta;
+    mHistory[mHistoryIndex] = flux;
+    mHistoryIndex = (mHistoryIndex + 1) % kMedianLength;
+
+    // was the previous hop a peak?
+    bool picked = false;
+    const uint64_t peakTime = sampleTime > kWindow / 2 + kHop ? sampleTime - kWindow / 2 - kHop : 0; // centre of last hop's window
+    if (mPrevFlux > mPrevThreshold && mPrevFlux > mPrevPrevFlux && mPrevFlux >= flux &&
+        (!mHasOnset || peakTime >= mLastOnset + minInterval)) {
+      event.sampleTime = peakTime;
+      event.strength = mPrevFlux - mPrevThreshold;
+      mLastOnset = peakTime;
+      mHasOnset = true;
+      picked = true;
+    }
+    mPrevPrevFlux = mPrevFlux;
+    mPrevFlux = flux;
+    mPrevThreshold = threshold;
+    return picked;
+  }
+
+  // flux of the latest hop, an onset-strength envelope at one value per hop
+  float flux() const {
+    return mPrevFlux;
+  }
+
+  // true if the last process() call completed a hop
+  bool hopped() const {
+    return mHopped;
+  }
+
+private:
+  gam::STFT stft;
+  std::vector<float> mPrev; // last hop's compressed magnitudes
+  std::vector<float> mHistory, mScratch; // flux ring and a copy to take the median in
+  unsigned mHistoryIndex = 0;
+  float mPrevFlux = 0.f, mPrevPrevFlux = 0.f, mPrevThreshold = 0.f;
+  uint64_t mLastOnset = 0;
+  bool mHasOnset = false;
+  bool mHopped = false;
+};
+
+#endif // EOYS_ONSET_DETECTOR_HPP
@@ -0,0 +1,294 @@
+#ifndef EOYS_PBO_TEXTURE_STREAM_HPP
+#define EOYS_PBO_TEXTURE_STREAM_HPP
+
+// std includes
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// al includes
+#include "al/graphics/al_OpenGL.hpp"
+
+// eoys includes
+#include "videoTiles.hpp"
+
+/**
+ * @brief Streams video frames into a texture through a ring of pixel buffer
+ * objects, so the render thread never waits on a frame copy.
+ *
+ * The render thread maps free PBOs and a worker thread fills them with the
+ * `fill` callback. Next frame the render thread unmaps the newest filled PBO
+ * and starts an upload from it into the back texture; the driver copies it
+ * while the frame renders. Front and back swap at the start of the frame after
+ * that, so texture() is always the upload finished a frame ago.
+ *
+ * setRegions() limits the copy and the upload to some rectangles of the
+ * frame, e.g. the tiles a renderer can see (see VideoTileGrid). The rest of
+ * the texture keeps whatever it had.
+ *
+ * open(), update(), texture() and close() are for the graphics thread only.
+ * request() can come from anywhere.
+ */
+class PboTextureStream {
+public:
+  static constexpr int kSlots = 3;
+
+  // writes `regions` of frame `index` into `height` rows of `width * channels` bytes, false if it isn't ready yet
+  using FillFunction = std::function<bool(int index, uint8_t* dst, const std::vector<VideoTile>& regions)>;
+
+  ~PboTextureStream() {
+    close();
+  }
+
+  // channels: 3 = BGR, 4 = BGRA, as OpenCV decodes
+  bool open(int width, int height, int channels, FillFunction fill) {
+    close();
+    mWidth = width;
+    mHeight = height;
+    mChannels = channels;
+    mBytes = size_t(width) * size_t(height) * size_t(channels);
+    mFill = std::move(fill);
+    VideoTile full;
+    full.width = width;
+    full.height = height;
+    mRegions.assign(1, full);
+
+    glGenTextures(2, mTextures);
+    for (GLuint texture : mTextures) {
+      glBindTexture(GL_TEXTURE_2D, texture);
+      glTexImage2D(GL_TEXTURE_2D, 0, channels == 4 ? GL_RGBA8 : GL_RGB8, width, height, 0, format(),
+                   GL_UNSIGNED_BYTE, nullptr);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT); // around the sphere's seam
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    for (Slot& slot : mSlots) {
+      glGenBuffers(1, &slot.buffer);
+      slot.state = Free;
+    }
+    mapFreeSlots();
+    if (glGetError() != GL_NO_ERROR) {
+      std::cerr << "PboTextureStream Error: Could not set up " << width << "x" << height << " buffers" << std::endl;
+      close();
+      return false;
+    }
+
+    mRequested = -1;
+    mFilled = -1;
+    mFront = 0;
+    mSwapPending = false;
+    mReady = false;
+    mRunning = true;
+    mWorker = std::thread([this]() { run(); });
+    return true;
+  }
+
+  void close() {
+    if (mWorker.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRunning = false;
+      }
+      mWake.notify_all();
+      mWorker.join();
+    }
+    if (!isOpen()) { return; }
+    for (Slot& slot : mSlots) {
+      if (slot.state.load() != Free) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      }
+      glDeleteBuffers(1, &slot.buffer);
+      slot.buffer = 0;
+      slot.data = nullptr;
+      slot.state = Free;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteTextures(2, mTextures);
+    mTextures[0] = mTextures[1] = 0;
+    mReady = false;
+  }
+
+  // the worker fills this frame next; repeats are ignored until refresh()
+  void request(int index) {
+    if (mRequested.exchange(index) != index) { mWake.notify_one(); }
+  }
+
+  // fill the requested frame again, e.g. once a placeholder has real pixels behind it
+  void refresh() {
+    mFilled = -1;
+    mWake.notify_one();
+  }
+
+  // only these rectangles are copied and uploaded from the next fill on
+  void setRegions(const std::vector<VideoTile>& regions) {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mRegions = regions;
+    }
+    refresh(); // newly visible regions need the current frame
+  }
+
+  /**
+   * @brief Once per frame before drawing: swaps in last frame's upload, starts
+   * the next one from the newest filled PBO and hands free PBOs back to the
+   * worker.
+   */
+  void update() {
+    if (!isOpen()) { return; }
+    if (mSwapPending) {
+      mFront ^= 1;
+      mSwapPending = false;
+      mReady = true;
+    }
+
+    Slot* newest = nullptr;
+    for (Slot& slot : mSlots) {
+      if (slot.state.load(std::memory_order_acquire) == Filled && (!newest || slot.sequence > newest->sequence)) {
+        newest = &slot;
+      }
+    }
+    for (Slot& slot : mSlots) {
+      if (slot.state.load(std::memory_order_acquire) != Filled) { continue; }
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+      const bool intact = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE; // false if the driver lost the memory
+      slot.data = nullptr;
+      if (&slot == newest && intact && !slot.regions.empty()) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // BGR rows needn't be multiples of 4
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, mWidth);
+        glBindTexture(GL_TEXTURE_2D, mTextures[mFront ^ 1]);
+        for (const VideoTile& region : slot.regions) {
+          const size_t offset = (size_t(region.y) * size_t(mWidth) + size_t(region.x)) * size_t(mChannels);
+          glTexSubImage2D(GL_TEXTURE_2D, 0, region.x, region.y, region.width, region.height, format(),
+                          GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(offset)); // from the PBO
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        mSwapPending = true;
+        mShown = slot.index;
+      } else if (&slot == newest && !intact) {
+        refresh();
+      }
+      slot.state = Free;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    mapFreeSlots();
+  }
+
+  // the texture to draw, the newest finished upload
+  GLuint texture() const {
+    return mTextures[mFront];
+  }
+
+  void bind(int unit = 0) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, texture());
+  }
+
+  void unbind(int unit = 0) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+
+  bool isOpen() const { return mTextures[0] != 0; }
+  bool ready() const { return mReady; } // a frame has made it to texture()
+  int shownFrame() const { return mShown; } // frame index in texture() (or about to be)
+
+private:
+  enum State { Free, Mapped, Filled };
+
+  struct Slot {
+    GLuint buffer = 0;
+    uint8_t* data = nullptr; // mapped memory, valid while Mapped or Filled
+    std::atomic<int> state { Free };
+    int index = -1;
+    uint64_t sequence = 0;
+    std::vector<VideoTile> regions; // what the worker filled
+  };
+
+  Slot mSlots[kSlots];
+  GLuint mTextures[2] = { 0, 0 };
+  int mFront = 0;
+  bool mSwapPending = false;
+  bool mReady = false;
+  int mShown = -1;
+  int mWidth = 0, mHeight = 0, mChannels = 3;
+  size_t mBytes = 0;
+  FillFunction mFill;
+
+  std::thread mWorker;
+  std::mutex mMutex;
+  std::condition_variable mWake;
+  bool mRunning = false;
+  std::vector<VideoTile> mRegions; // guarded by mMutex
+  std::atomic<int> mRequested { -1 };
+  std::atomic<int> mFilled { -1 }; // last frame the worker filled
+  uint64_t mSequence = 0;
+
+  GLenum format() const {
+    return mChannels == 4 ? GL_BGRA : GL_BGR;
+  }
+
+  void mapFreeSlots() {
+    bool mapped = false;
+    for (Slot& slot : mSlots) {
+      if (slot.state.load(std::memory_order_acquire) != Free) { continue; }
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, GLsizeiptr(mBytes), nullptr, GL_STREAM_DRAW); // orphan, never waits on the GPU
+      slot.data = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, GLsizeiptr(mBytes),
+                                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+      if (slot.data) {
+        slot.state.store(Mapped, std::memory_order_release);
+        mapped = true;
+      }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (mapped) { mWake.notify_one(); }
+  }
+
+  // worker: fills a mapped slot whenever there's a new frame to show
+  void run() {
+    while (true) {
+      Slot* target = nullptr;
+      int index = -1;
+      std::vector<VideoTile> regions;
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        // a fill that wasn't ready comes back to be retried
+        mWake.wait_for(lock, std::chrono::milliseconds(5), [this]() {
+          return !mRunning || (mRequested.load() >= 0 && mRequested.load() != mFilled.load() && mappedSlot());
+        });
+        if (!mRunning) { return; }
+        index = mRequested.load();
+        target = mappedSlot();
+        if (index < 0 || index == mFilled.load() || !target) { continue; }
+        regions = mRegions;
+      }
+      if (!mFill(index, target->data, regions)) { continue; }
+      target->regions.swap(regions);
+      target->index = index;
+      target->sequence = ++mSequence;
+      mFilled = index;
+      target->state.store(Filled, std::memory_order_release);
+    }
+  }
+
+  Slot* mappedSlot() {
+    for (Slot& slot : mSlots) {
+      if (slot.state.load(std::memory_order_acquire) == Mapped) { return &slot; }
+    }
+    return nullptr;
+  }
+};
+
+#endif // EOYS_PBO_TEXTURE_STREAM_HPP
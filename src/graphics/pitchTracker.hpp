@@ -0,0 +1,131 @@
+#ifndef EOYS_PITCH_TRACKER_HPP
+#define EOYS_PITCH_TRACKER_HPP
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Gamma includes
+#include "Gamma/FFT.h"
+#include "Gamma/Types.h"
+
+/**
+ * @brief Monophonic pitch tracker using the McLeod Pitch Method (MPM).
+ *
+ * Every `kHop` samples it takes the last `kWindow` samples and computes the
+ * normalized square difference function from an FFT autocorrelation
+ * (zero-padded to twice the window, so it's linear, not circular). It then
+ * picks the first key maximum within `clarityThreshold` of the highest one,
+ * and refines it by parabolic interpolation. A 2048 window reaches down to
+ * about 43Hz at 44.1kHz, which covers bass, guitar and voice.
+ *
+ * All buffers are allocated in the constructor; process() is audio-thread safe
+ * and costs one forward and one inverse FFT per hop.
+ */
+class PitchTracker {
+public:
+  static constexpr int kWindow = 2048;
+  static constexpr int kHop = 512;
+  float clarityThreshold = 0.9f; // of the highest key maximum
+  float minConfidence = 0.5f; // below this, report unvoiced
+  float silenceRms = 0.005f;
+  float maxFrequency = 1500.f;
+
+  PitchTracker() : mFft(2 * kWindow) {
+    mInput.assign(kWindow, 0.f);
+    mFrame.assign(kWindow, 0.f);
+    mSpectrum.assign(2 * kWindow, gam::Complex<float>(0.f, 0.f));
+    mNsdf.assign(kWindow / 2, 0.f);
+  }
+
+  void setSampleRate(float sampleRate) {
+    mSampleRate = sampleRate;
+  }
+
+  // call per input sample, returns true when a new estimate is ready
+  bool process(float inputSample) {
+    mInput[mWrite] = inputSample;
+    mWrite = (mWrite + 1) % kWindow;
+    if (++mSinceHop < kHop) { return false; }
+    mSinceHop = 0;
+    estimate();
+    return true;
+  }
+
+  float frequency() const { return mFrequency; } // Hz, 0 if unvoiced
+  float confidence() const { return mConfidence; } // 0..1, NSDF value at the pitch peak
+
+private:
+  gam::CFFT<float> mFft;
+  std::vector<float> mInput, mFrame; // ring, and the ring unrolled oldest first
+  std::vector<gam::Complex<float>> mSpectrum;
+  std::vector<float> mNsdf;
+  int mWrite = 0, mSinceHop = 0;
+  float mSampleRate = 44100.f;
+  float mFrequency = 0.f, mConfidence = 0.f;
+
+  void estimate() {
+    float energy = 0.f;
+    for (int i = 0; i < kWindow; i++) {
+      mFrame[i] = mInput[(mWrite + i) % kWindow];
+      energy += mFrame[i] * mFrame[i];
+    }
+    if (std::sqrt(energy / kWindow) < silenceRms) {
+      mFrequency = mConfidence = 0.f;
+      return;
+    }
+
+    // autocorrelation r(tau) = IFFT(|FFT(x)|^2), zero-padded
+    for (int i = 0; i < kWindow; i++) { mSpectrum[i] = gam::Complex<float>(mFrame[i], 0.f); }
+    for (int i = kWindow; i < 2 * kWindow; i++) { mSpectrum[i] = gam::Complex<float>(0.f, 0.f); }
+    mFft.forward(mSpectrum.data());
+    for (auto& bin : mSpectrum) { bin = gam::Complex<float>(bin.norm2(), 0.f); }
+    mFft.inverse(mSpectrum.data());
+    const float scale = energy / mSpectrum[0].r; // r(0) is the energy, whatever the FFT's scaling
+
+    // nsdf(tau) = 2 r(tau) / m(tau), m(tau) = sum of x_j^2 + x_{j+tau}^2 over the overlap
+    float m = 2.f * energy;
+    const int minTau = std::max(2, int(mSampleRate / maxFrequency));
+    for (int tau = 0; tau < kWindow / 2; tau++) {
+      if (tau > 0) {
+        m -= mFrame[tau - 1] * mFrame[tau - 1] + mFrame[kWindow - tau] * mFrame[kWindow - tau];
+      }
+      mNsdf[tau] = m > 0.f ? 2.f * mSpectrum[tau].r * scale / m : 0.f;
+    }
+
+    // key maxima: the highest point between each positive-going and the next
+    // negative-going zero crossing, starting after the first negative region
+    int tau = 1;
+    while (tau < kWindow / 2 && mNsdf[tau] > 0.f) { tau++; }
+    float highest = 0.f;
+    int candidates[32];
+    int numCandidates = 0;
+    while (tau < kWindow / 2 && numCandidates < 32) {
+      while (tau < kWindow / 2 && mNsdf[tau] <= 0.f) { tau++; }
+      int peak = -1;
+      while (tau < kWindow / 2 && mNsdf[tau] > 0.f) {
+        if (tau >= minTau && (peak < 0 || mNsdf[tau] > mNsdf[peak])) { peak = tau; }
+        tau++;
+      }
+      if (peak > 0 && peak < kWindow / 2 - 1) {
+        candidates[numCandidates++] = peak;
+        highest = std::max(highest, mNsdf[peak]);
+      }
+    }
+
+    for (int c = 0; c < numCandidates; c++) {
+      const int peak = candidates[c];
+      if (mNsdf[peak] < clarityThreshold * highest) { continue; }
+      const float a = mNsdf[peak - 1], b = mNsdf[peak], d = mNsdf[peak + 1];
+      const float denom = a - 2.f * b + d;
+      const float offset = denom < 0.f ? 0.5f * (a - d) / denom : 0.f;
+      mConfidence = std::min(b, 1.f);
+      mFrequency = mConfidence >= minConfidence ? mSampleRate / (peak + offset) : 0.f;
+      return;
+    }
+    mFrequency = mConfidence = 0.f;
+  }
+};
+
+#endif // EOYS_PITCH_TRACKER_HPP
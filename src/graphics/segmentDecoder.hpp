@@ -0,0 +1,153 @@
+#ifndef EOYS_SEGMENT_DECODER_HPP
+#define EOYS_SEGMENT_DECODER_HPP
+
+// std includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// opencv includes
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+/**
+ * @brief A run of frames [begin, end) that starts on a keyframe, so it can be
+ * decoded by itself.
+ */
+struct VideoSegment {
+  int begin = 0;
+  int end = 0;
+};
+
+/**
+ * @brief Decodes a whole video into memory on several threads at once.
+ *
+ * scanKeyframes() reads the packets without decoding them to find the
+ * keyframes. splitAtKeyframes() cuts the video at the keyframes nearest to
+ * equal shares. decode() then runs a pool of workers. Each takes one segment
+ * at a time with its own capture and writes straight into its slots of the
+ * output, so frames come out in order without merging. Preload time scales
+ * with cores instead of being bound to one decoder.
+ */
+class SegmentDecoder {
+public:
+  /**
+   * @brief Frame indices of the keyframes in `path`, always starting with 0.
+   * Sets `frameCount` to the packets counted. If the backend can't report
+   * keyframes, returns just {0} and the container's frame count, and
+   * splitAtKeyframes() falls back to equal cuts.
+   */
+  static std::vector<int> scanKeyframes(const std::string& path, int& frameCount) {
+    std::vector<int> keyframes { 0 };
+    cv::VideoCapture capture(path);
+    frameCount = int(capture.get(cv::CAP_PROP_FRAME_COUNT));
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 5)
+    if (!capture.isOpened() || !capture.set(cv::CAP_PROP_FORMAT, -1)) { return keyframes; } // raw packets, no decode
+    int packets = 0;
+    while (capture.grab()) {
+      if (packets > 0 && capture.get(cv::CAP_PROP_LRF_HAS_KEY_FRAME) != 0.0) { keyframes.push_back(packets); }
+      packets++;
+    }
+    if (packets > 0) { frameCount = packets; }
+#endif
+    return keyframes;
+  }
+
+  /**
+   * @brief At most `parts` segments covering [0, frameCount), each starting on
+   * a keyframe. With only {0} as keyframes, cuts into equal shares instead;
+   * the capture then seeks to each start, which costs a little extra decode.
+   */
+  static std::vector<VideoSegment> splitAtKeyframes(const std::vector<int>& keyframes, int frameCount, int parts) {
+    std::vector<VideoSegment> segments;
+    if (frameCount <= 0) { return segments; }
+    parts = std::max(1, std::min(parts, frameCount));
+
+    std::vector<int> cuts { 0 };
+    for (int p = 1; p < parts; p++) {
+      const int target = int(int64_t(frameCount) * p / parts);
+      int cut = target;
+      if (keyframes.size() > 1) { // nearest keyframe to the even share
+        auto it = std::lower_bound(keyframes.begin(), keyframes.end(), target);
+        cut = it == keyframes.end() ? keyframes.back() : *it;
+        if (it != keyframes.begin() && (it == keyframes.end() || target - *(it - 1) < *it - target)) { cut = *(it - 1); }
+      }
+      if (cut > cuts.back() && cut < frameCount) { cuts.push_back(cut); }
+    }
+    for (size_t i = 0; i < cuts.size(); i++) {
+      VideoSegment segment;
+      segment.begin = cuts[i];
+      segment.end = i + 1 < cuts.size() ? cuts[i + 1] : frameCount;
+      segments.push_back(segment);
+    }
+    return segments;
+  }
+
+  /**
+   * @brief Decodes `segments` of `path` into `frames` (resized to cover them)
+   * on up to `workers` threads. Stops early when `keepGoing` goes false.
+   * Returns the number of frames decoded; slots a segment couldn't fill stay
+   * empty.
+   */
+  static int decode(const std::string& path, const std::vector<VideoSegment>& segments, std::vector<cv::Mat>& frames,
+                    const std::atomic<bool>& keepGoing, unsigned workers) {
+    if (segments.empty()) { return 0; }
+    frames.assign(segments.back().end, cv::Mat());
+    std::atomic<size_t> nextSegment { 0 };
+    std::atomic<int> decoded { 0 };
+    std::mutex logMutex;
+    const auto start = std::chrono::steady_clock::now();
+
+    auto work = [&]() {
+      try {
+        decodeSegments(path, segments, frames, keepGoing, nextSegment, decoded, logMutex, start);
+      } catch (const cv::Exception& e) {
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::cerr << "SegmentDecoder Error: " << e.what() << std::endl;
+      }
+    };
+
+    std::vector<std::thread> pool;
+    const unsigned threads = std::max(1u, std::min(workers, unsigned(segments.size())));
+    for (unsigned t = 0; t < threads; t++) { pool.emplace_back(work); }
+    for (auto& thread : pool) { thread.join(); }
+    return decoded.load();
+  }
+
+private:
+  // one worker: takes segments until there are none left
+  static void decodeSegments(const std::string& path, const std::vector<VideoSegment>& segments,
+                             std::vector<cv::Mat>& frames, const std::atomic<bool>& keepGoing,
+                             std::atomic<size_t>& nextSegment, std::atomic<int>& decoded, std::mutex& logMutex,
+                             std::chrono::steady_clock::time_point start) {
+    cv::VideoCapture capture;
+    size_t s;
+    while (keepGoing.load() && (s = nextSegment.fetch_add(1)) < segments.size()) {
+      const VideoSegment& segment = segments[s];
+      if (!capture.isOpened() && !capture.open(path)) {
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::cerr << "SegmentDecoder Error: Could not open " << path << std::endl;
+        return;
+      }
+      capture.set(cv::CAP_PROP_POS_FRAMES, segment.begin); // a keyframe, so no decoding to get there
+      int count = 0;
+      for (int f = segment.begin; f < segment.end && keepGoing.load(); f++) {
+        if (!capture.read(frames[f]) || frames[f].empty()) { break; } // read allocates, every slot owns its pixels
+        count++;
+      }
+      decoded += count;
+      const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      std::lock_guard<std::mutex> lock(logMutex);
+      std::cout << "  Segment " << s + 1 << " of " << segments.size() << ": frames " << segment.begin << "-"
+                << segment.begin + count - 1 << " (" << count << "/" << segment.end - segment.begin << ") at "
+                << seconds << "s" << std::endl;
+    }
+  }
+};
+
+#endif // EOYS_SEGMENT_DECODER_HPP
@@ -11,21 +11,30 @@
 
 // eoys includes
 #include "shaderToSphere.hpp"
-#include "audioReactor.hpp" 
+#include "analysisBus.hpp"
+#include "audioTextures.hpp"
+#include "drumTriggers.hpp"
 #include "vfxUtility.hpp"
 #include "vfxMain.hpp"
 
 class ShaderEngine : public al::PositionedVoice {
 private:
   ShadedSphere shaderSphere;
-  SpectralListener specListen;
-  DynamicListener dynListen;
+  uint32_t mLastOnsets = 0; // onset count last seen on the analysis bus
+  AudioTextures mAudioTextures;
+  bool mSpectrumChanged = false;
 
   al::Parameter now {"now", "", 0.f, 0.f, std::numeric_limits<float>::max()};
   al::Parameter flux {"flux", "", 0.01f, 0.f, 1.f};
   al::Parameter centroid = {"centroid", "", 1.f, 0.f, 20000.f};
   al::Parameter rms = {"rms", "", 0.f, 0.f, 1.f};
   al::Parameter onsetIncrement = {"onsetIncrement", "", 0.f, 0.f, 100.f};
+  al::Parameter beatPhase = {"beatPhase", "", 0.f, 0.f, 1.f};
+  al::Parameter bpm = {"bpm", "", 0.f, 0.f, 300.f};
+  al::Parameter pitch = {"pitch", "", 0.f, 0.f, 2000.f};
+  al::Parameter kick = {"kick", "", 0.f, 0.f, 1.f}; // decaying hit envelopes, see drumEnvelope()
+  al::Parameter snare = {"snare", "", 0.f, 0.f, 1.f};
+  al::Parameter toms = {"toms", "", 0.f, 0.f, 1.f};
   al::ParameterInt mChannel = {"mChannel", "", 0, 0, 8};
   al::ParameterBundle mParams {"Uniforms"};
   al::ControlGUI mGUI;
@@ -33,13 +42,11 @@ private:
   al::ParameterBool networkedInitFlag { "networkedInitFlag", "", true };
   bool initFlag = true;
 
-  FloatReporter fluxReporter;
-  FloatReporter centroidReporter;
-  FloatReporter rmsReporter;
   giml::OnePole<float> mOnePole;
   giml::OnePole<float> mOnePoleCent;
 
   al::ParameterString fragPath = {"fragPath", "", "../src/shaders/julia.frag"};
+  al::ParameterString spectrum = {"spectrum", "", ""}; // quantized SpectrumFrame, see AudioTextures
 
 public:
 
@@ -53,9 +60,8 @@ public:
 
   // make sure al::imguiInit() is called before this
   void init() override {
-    dynListen.setSilenceThresh(0.1);
-    mGUI << now << flux << centroid << rms << onsetIncrement << mChannel;
-    mParams << now << flux << centroid << rms << onsetIncrement << mChannel << fragPath << networkedInitFlag;
+    mGUI << now << flux << centroid << rms << onsetIncrement << beatPhase << bpm << pitch << kick << snare << toms << mChannel;
+    mParams << now << flux << centroid << rms << onsetIncrement << beatPhase << bpm << pitch << kick << snare << toms << mChannel << fragPath << spectrum << networkedInitFlag;
     mParams << mPose;
     // plz tell me there's a better way to do this
     for (auto& param : mParams.parameters()) {
@@ -65,6 +71,10 @@ public:
     shaderSphere.setSphere(15.f, 1000); // see VAOMesh::update(), moved to draw function
     //this->shader(); // moved to draw function, triggered by flag.
 
+    spectrum.registerChangeCallback([this](std::string value) {
+      this->mSpectrumChanged = true;
+    });
+
     networkedInitFlag.registerChangeCallback([this](bool value) {
       this->initFlag = true;
       std::cout << "NetworkedInitFlag changed, setting initFlag to true" << std::endl;
@@ -91,30 +101,46 @@ public:
 
       now = now + float(dt);
 
+      // features are computed once per input channel, see AnalysisBus
+      analysisBus().subscribe(mChannel);
+      FeatureFrame features = analysisBus().latest(mChannel);
+
       mOnePoleCent.setCutoff(15000, 60);
-      centroid = mOnePoleCent.lpf(centroidReporter.reportValue());
+      centroid = mOnePoleCent.lpf(features.centroid);
 
       mOnePole.setCutoff(1000, 60);
-      flux = mOnePole.lpf(fluxReporter.reportValue());
+      flux = mOnePole.lpf(features.flux);
 
-      if (dynListen.detectOnset()) {
-        std::cout << "NEW ONSET" << std::endl;
-        onsetIncrement = onsetIncrement + 0.1f;
+      rms = features.rms;
+      if (features.pitch > 0.f) { pitch = features.pitch; } // hold the last note through unvoiced frames
+
+      if (features.onsets != mLastOnsets) { // every hit since last frame, once each
+        onsetIncrement = onsetIncrement + 0.1f * float(features.onsets - mLastOnsets);
+        mLastOnsets = features.onsets;
       }
+
+      std::string encoded = AudioTextures::encode(analysisBus().latestSpectrum(mChannel));
+      if (encoded != spectrum.get()) { spectrum = encoded; } // only send when it changed
+
+      beatPhase = analysisBus().beatPhase();
+      bpm = analysisBus().beat().bpm;
+
+      kick = drumEnvelope("Kick");
+      snare = drumEnvelope("Snare");
+      toms = std::max(drumEnvelope("Floor Tom"), std::max(drumEnvelope("Mid Tom"), drumEnvelope("High Tom")));
     }
   }
 
-  void onProcess(al::AudioIOData& io) override {
-    if (!mIsReplica) {
-      for (auto sample = 0; sample < io.framesPerBuffer(); sample++) {
-        const float in = io.in(mChannel, sample);
-        specListen.process(in);
-        dynListen.process(in);
-        centroidReporter.write(in);
-        fluxReporter.write(in);
-        rmsReporter.write(in);
-      }
-    }
+  // velocity of the last hit on `name`, decayed by its age in input samples rather than frames
+  float drumEnvelope(const std::string& name, float decaySeconds = 0.15f) {
+    int drum = drumTriggers().find(name);
+    if (drum < 0) { return 0.f; }
+    DrumState state = drumTriggers().latest(unsigned(drum));
+    if (state.hits == 0) { return 0.f; }
+    const uint64_t now = drumTriggers().sampleTime();
+    const float age = float(now - std::min(now, state.lastHitTime)) / drumTriggers().sampleRate();
+    const float envelope = state.velocity * std::exp(-age / decaySeconds);
+    return envelope > 0.001f ? envelope : 0.f; // settle at 0 so replicas stop getting updates
   }
 
   void onProcess(al::Graphics& g) override {
@@ -132,11 +158,23 @@ public:
     shaderSphere.setUniformFloat("onset", onsetIncrement);
     shaderSphere.setUniformFloat("cent", centroid);
     shaderSphere.setUniformFloat("flux", flux);
+    shaderSphere.setUniformFloat("beatPhase", beatPhase);
+    shaderSphere.setUniformFloat("bpm", bpm);
+    shaderSphere.setUniformFloat("pitch", pitch);
+    shaderSphere.setUniformFloat("kick", kick);
+    shaderSphere.setUniformFloat("snare", snare);
+    shaderSphere.setUniformFloat("toms", toms);
+    if (mSpectrumChanged) {
+      mSpectrumChanged = false;
+      mAudioTextures.decode(spectrum.get());
+    }
+    mAudioTextures.bind(shaderSphere.shader());
 
     // draw
     if (mIsReplica) {
       shaderSphere.draw(g);
     }
+    mAudioTextures.unbind();
 
     // draw GUI 
     if (!mIsReplica) {
@@ -0,0 +1,231 @@
+#ifndef EOYS_VIDEO_STREAM_HPP
+#define EOYS_VIDEO_STREAM_HPP
+
+// std includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// opencv includes
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+/**
+ * @brief Decodes a video file on its own thread into a bounded ring of frames
+ * just ahead of the playhead, so playback never needs the whole file in memory.
+ *
+ * The ring holds at most `budgetBytes` of decoded frames (at least two).
+ * Frames behind the playhead are dropped as it moves. When looping, the
+ * decoder wraps to the start as soon as it reaches the end, so the head of the
+ * file is decoded while the tail plays. If the whole video fits in the budget,
+ * nothing is ever dropped and it plays from memory after one pass.
+ *
+ * One consumer thread calls acquire() with the frame it wants: the
+ * PboTextureStream worker when uploads are asynchronous, otherwise the render
+ * thread. The returned Mat shares memory with the ring, so nothing is copied,
+ * and it stays valid after the decoder drops the frame from the ring.
+ */
+class VideoStream {
+public:
+  static constexpr size_t kDefaultBudget = size_t(512) << 20; // 512MB, ~60 frames of 1080p
+
+  ~VideoStream() {
+    close();
+  }
+
+  /**
+   * @brief Opens `path` and starts decoding from frame 0. Returns false if the
+   * file can't be opened.
+   */
+  bool open(const std::string& path, bool looping, size_t budgetBytes = kDefaultBudget) {
+    close();
+    if (!mCapture.open(path) || !mCapture.isOpened()) {
+      std::cerr << "VideoStream Error: Could not open " << path << std::endl;
+      return false;
+    }
+    mWidth = int(mCapture.get(cv::CAP_PROP_FRAME_WIDTH));
+    mHeight = int(mCapture.get(cv::CAP_PROP_FRAME_HEIGHT));
+    mFrameRate = mCapture.get(cv::CAP_PROP_FPS);
+    mFrameCount = std::max(1, int(mCapture.get(cv::CAP_PROP_FRAME_COUNT)));
+    const size_t frameBytes = std::max<size_t>(1, size_t(mWidth) * size_t(mHeight) * 4);
+    mCapacity = int(std::max<size_t>(2, budgetBytes / frameBytes));
+    mLooping = looping;
+    mPlayhead = 0;
+    mNext = 0;
+    mMisses = 0;
+    mReady = false;
+    mStopping = false;
+    mThread = std::thread([this]() { run(); });
+    return true;
+  }
+
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStopping = true;
+    }
+    mWake.notify_all();
+    if (mThread.joinable()) { mThread.join(); }
+    mRing.clear();
+    mCapture.release();
+  }
+
+  void setLooping(bool looping) {
+    if (mLooping.exchange(looping) != looping) { mWake.notify_all(); }
+  }
+
+  /**
+   * @brief Consumer thread: moves the playhead to `frame` and returns it in
+   * `out` if it has been decoded. Returns false if it hasn't yet, in which case
+   * keep showing the previous frame.
+   */
+  bool acquire(int frame, cv::Mat& out) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (frame != mPlayhead) {
+      mPlayhead = frame;
+      mWake.notify_all();
+    }
+    for (const auto& entry : mRing) {
+      if (entry.index == frame) {
+        out = entry.image;
+        return true;
+      }
+    }
+    mMisses++;
+    return false;
+  }
+
+  // true once frame 0 is decoded, start the clock then
+  bool ready() const { return mReady.load(); }
+
+  // from the container until the decoder finds the real end
+  int frameCount() const { return mFrameCount.load(); }
+  double frameRate() const { return mFrameRate; }
+  int width() const { return mWidth; }
+  int height() const { return mHeight; }
+
+  // frames the ring can hold within the budget
+  int capacity() const { return mCapacity; }
+
+  // times acquire() asked for a frame that wasn't decoded yet
+  uint64_t misses() const { return mMisses.load(); }
+
+private:
+  struct Entry {
+    int index;
+    cv::Mat image;
+  };
+
+  cv::VideoCapture mCapture; // decode thread only, once started
+  std::thread mThread;
+  std::mutex mMutex;
+  std::condition_variable mWake;
+  std::deque<Entry> mRing; // in decode order
+  int mPlayhead = 0; // guarded by mMutex
+  int mNext = 0; // next frame the capture will return, decode thread only
+  int mCapacity = 2;
+  int mWidth = 0, mHeight = 0;
+  double mFrameRate = 30.0;
+  std::atomic<int> mFrameCount { 1 };
+  std::atomic<bool> mLooping { true };
+  std::atomic<bool> mReady { false };
+  std::atomic<uint64_t> mMisses { 0 };
+  bool mStopping = false; // guarded by mMutex
+
+  // frames from the playhead to `index`, wrapping when looping; negative means behind
+  int ahead(int index) const {
+    const int count = mFrameCount.load();
+    const int distance = index - mPlayhead;
+    return mLooping.load() ? (distance + count) % count : distance;
+  }
+
+  bool inWindow(int index) const {
+    const int distance = ahead(index);
+    return distance >= 0 && distance < mCapacity;
+  }
+
+  bool contains(int index) const {
+    for (const auto& entry : mRing) {
+      if (entry.index == index) { return true; }
+    }
+    return false;
+  }
+
+  // decode thread
+  void run() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (!mStopping) {
+      const int count = mFrameCount.load();
+      const bool cachedAll = int(mRing.size()) >= count; // everything fits, never drop
+      if (!cachedAll) {
+        mRing.erase(std::remove_if(mRing.begin(), mRing.end(),
+                                   [this](const Entry& entry) { return !inWindow(entry.index); }),
+                    mRing.end());
+      }
+
+      // the playhead jumped somewhere the decoder won't reach soon (restart, seek, fell far behind)
+      const bool missing = !contains(mPlayhead);
+      const int behind = (mPlayhead - mNext + count) % count;
+      const bool catchingUp = missing && behind > 0 && behind < std::max(mCapacity, int(mFrameRate));
+      if (missing && mNext != mPlayhead && !catchingUp && !cachedAll) {
+        mRing.clear();
+        mNext = mPlayhead;
+        lock.unlock();
+        mCapture.set(cv::CAP_PROP_POS_FRAMES, mNext);
+        lock.lock();
+        continue;
+      }
+
+      const bool atEnd = mNext >= count && !mLooping.load();
+      const bool full = cachedAll || (!catchingUp && !inWindow(mNext)) || atEnd;
+      if (full) {
+        mWake.wait_for(lock, std::chrono::milliseconds(20)); // woken early when the playhead moves
+        continue;
+      }
+
+      if (mNext >= count) { // wrap: start on the head while the tail plays
+        mNext = 0;
+        lock.unlock();
+        mCapture.set(cv::CAP_PROP_POS_FRAMES, 0);
+        lock.lock();
+        continue;
+      }
+
+      const int index = mNext;
+      lock.unlock();
+      cv::Mat image; // fresh each time, the renderer may still hold the last one
+      bool decoded;
+      if (catchingUp) {
+        decoded = mCapture.grab(); // behind the playhead anyway, skip the color conversion
+      } else {
+        decoded = mCapture.read(image) && !image.empty();
+      }
+      lock.lock();
+
+      if (!decoded) {
+        if (index == 0) {
+          std::cerr << "VideoStream Error: Could not decode the first frame" << std::endl;
+          mStopping = true;
+          break;
+        }
+        mFrameCount = index; // the container overstated the length, this is the real end
+        mNext = index; // wraps or waits on the next pass
+        continue;
+      }
+      mNext = index + 1;
+      if (!catchingUp) {
+        mRing.push_back({ index, image });
+        if (index == 0) { mReady = true; }
+      }
+    }
+  }
+};
+
+#endif // EOYS_VIDEO_STREAM_HPP
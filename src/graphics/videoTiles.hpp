@@ -0,0 +1,206 @@
+#ifndef EOYS_VIDEO_TILES_HPP
+#define EOYS_VIDEO_TILES_HPP
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+// al includes
+#include "al/math/al_Quat.hpp"
+#include "al/math/al_Vec.hpp"
+
+/**
+ * @brief A rectangle of video pixels, top-left origin like OpenCV.
+ */
+struct VideoTile {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+};
+
+/**
+ * @brief What one projector of a renderer shows, in the viewer's frame: a
+ * look direction and a field of view. Yaw turns left from -z, pitch looks up.
+ */
+struct ViewFrustum {
+  al::Vec3d forward { 0, 0, -1 };
+  al::Vec3d right { 1, 0, 0 };
+  al::Vec3d up { 0, 1, 0 };
+  double tanHalfX = 1.0;
+  double tanHalfY = 1.0;
+
+  static ViewFrustum fromDegrees(double yaw, double pitch, double fovX, double fovY) {
+    const double toRad = M_PI / 180.0;
+    ViewFrustum view;
+    view.forward = al::Vec3d(-std::sin(yaw * toRad) * std::cos(pitch * toRad), std::sin(pitch * toRad),
+                             -std::cos(yaw * toRad) * std::cos(pitch * toRad));
+    view.right = al::cross(view.forward, al::Vec3d(0, 1, 0));
+    if (view.right.mag() < 1e-6) { view.right = al::Vec3d(1, 0, 0); } // straight up or down
+    view.right.normalize();
+    view.up = al::cross(view.right, view.forward);
+    view.tanHalfX = std::tan(std::min(fovX, 170.0) * 0.5 * toRad);
+    view.tanHalfY = std::tan(std::min(fovY, 170.0) * 0.5 * toRad);
+    return view;
+  }
+
+  bool contains(const al::Vec3d& direction, double margin) const {
+    const double z = direction.dot(forward);
+    if (z <= 0.0) { return false; }
+    return std::abs(direction.dot(right)) <= z * tanHalfX * margin && std::abs(direction.dot(up)) <= z * tanHalfY * margin;
+  }
+
+  /**
+   * @brief The views of `host` in a render-view file, empty if it has none.
+   * One line per projector: `host yaw pitch fovX fovY` in degrees, # comments.
+   */
+  static std::vector<ViewFrustum> load(const std::string& path, const std::string& host) {
+    std::vector<ViewFrustum> views;
+    std::ifstream file(path);
+    if (!file.is_open()) { return views; } // no file: every node gets the whole frame
+    std::string line;
+    while (std::getline(file, line)) {
+      line = line.substr(0, line.find('#'));
+      std::istringstream fields(line);
+      std::string name;
+      double yaw, pitch, fovX, fovY;
+      if (!(fields >> name)) { continue; }
+      if (!(fields >> yaw >> pitch >> fovX >> fovY)) {
+        std::cerr << "ViewFrustum Error: Bad line in " << path << ": " << line << std::endl;
+        continue;
+      }
+      if (name == host) { views.push_back(fromDegrees(yaw, pitch, fovX, fovY)); }
+    }
+    return views;
+  }
+
+  static std::string hostName() {
+#if defined(_WIN32)
+    return "";
+#else
+    char name[256] = {};
+    gethostname(name, sizeof(name) - 1);
+    return name;
+#endif
+  }
+};
+
+/**
+ * @brief Splits an equirectangular frame into a grid of tiles and finds the
+ * ones a renderer's projectors can see, so only those get copied and
+ * uploaded.
+ *
+ * Each tile is sampled on a small grid of points. Every point becomes a
+ * direction through the mapping addTexSphere gives the sphere mesh: rows run
+ * from the north pole down, columns run around +y. A tile is visible when any
+ * point falls inside a slightly widened frustum. The margin covers texture
+ * filtering and the frame that an upload trails the view by.
+ */
+class VideoTileGrid {
+public:
+  static constexpr int kSamples = 6; // per tile side
+  static constexpr double kMargin = 1.15; // frustum widening
+
+  void configure(int width, int height, int columns = 8, int rows = 4) {
+    mWidth = width;
+    mHeight = height;
+    mColumns = std::max(1, std::min(columns, width));
+    mRows = std::max(1, std::min(rows, height));
+    mVisible.assign(size_t(mColumns * mRows), 1);
+    mRegions.assign(1, tile(0, 0, mColumns, mRows));
+  }
+
+  /**
+   * @brief Recomputes the visible tiles for the sphere drawn with
+   * `orientation` and then turned `yawDegrees` about +y. Returns true if the
+   * set changed.
+   */
+  bool update(const std::vector<ViewFrustum>& views, const al::Quatd& orientation, double yawDegrees) {
+    if (views.empty() || mWidth == 0) { return false; }
+    const double yaw = yawDegrees * M_PI / 180.0;
+    const double cosYaw = std::cos(yaw), sinYaw = std::sin(yaw);
+    std::vector<char> visible(mVisible.size(), 0);
+    for (int row = 0; row < mRows; row++) {
+      for (int column = 0; column < mColumns; column++) {
+        const VideoTile t = tile(column, row, 1, 1);
+        bool seen = false;
+        for (int sy = 0; sy < kSamples && !seen; sy++) {
+          for (int sx = 0; sx < kSamples && !seen; sx++) {
+            const double u = (t.x + t.width * double(sx) / (kSamples - 1)) / mWidth;
+            const double v = (t.y + t.height * double(sy) / (kSamples - 1)) / mHeight;
+            al::Vec3d d = sphereDirection(u, v);
+            d = orientation.rotate(al::Vec3d(cosYaw * d.x + sinYaw * d.z, d.y, -sinYaw * d.x + cosYaw * d.z));
+            for (const ViewFrustum& view : views) {
+              if (view.contains(d, kMargin)) {
+                seen = true;
+                break;
+              }
+            }
+          }
+        }
+        visible[size_t(row * mColumns + column)] = seen;
+      }
+    }
+    if (visible == mVisible) { return false; }
+    mVisible.swap(visible);
+
+    // runs of visible tiles along each row become one rectangle
+    mRegions.clear();
+    for (int row = 0; row < mRows; row++) {
+      for (int column = 0; column < mColumns;) {
+        if (!mVisible[size_t(row * mColumns + column)]) {
+          column++;
+          continue;
+        }
+        int end = column;
+        while (end < mColumns && mVisible[size_t(row * mColumns + end)]) { end++; }
+        mRegions.push_back(tile(column, row, end - column, 1));
+        column = end;
+      }
+    }
+    return true;
+  }
+
+  // rectangles covering the visible tiles; the whole frame until update() says otherwise
+  const std::vector<VideoTile>& regions() const { return mRegions; }
+
+  // fraction of tiles visible, what this node uploads compared to the full frame
+  double coverage() const {
+    if (mVisible.empty()) { return 1.0; }
+    return double(std::count(mVisible.begin(), mVisible.end(), 1)) / double(mVisible.size());
+  }
+
+  // unit direction of texture coordinate (u, v), the layout addTexSphere uses
+  static al::Vec3d sphereDirection(double u, double v) {
+    const double theta = v * M_PI; // from the north pole
+    const double phi = (1.0 - u) * 2.0 * M_PI;
+    return al::Vec3d(std::cos(phi) * std::sin(theta), std::cos(theta), std::sin(phi) * std::sin(theta));
+  }
+
+private:
+  int mWidth = 0, mHeight = 0;
+  int mColumns = 1, mRows = 1;
+  std::vector<char> mVisible;
+  std::vector<VideoTile> mRegions;
+
+  // pixel bounds of `columns` x `rows` tiles from (column, row), the last ones take the remainder
+  VideoTile tile(int column, int row, int columns, int rows) const {
+    VideoTile t;
+    t.x = column * mWidth / mColumns;
+    t.y = row * mHeight / mRows;
+    t.width = (column + columns) * mWidth / mColumns - t.x;
+    t.height = (row + rows) * mHeight / mRows - t.y;
+    return t;
+  }
+};
+
+#endif // EOYS_VIDEO_TILES_HPP
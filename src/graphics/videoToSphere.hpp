@@ -7,6 +7,9 @@
 #include <iostream>
 #include <chrono>
 
+#include "yuvConvert.hpp"
+#include "yuvTextures.hpp"
+
 class VideoSphereLoader {
 private:
   Mesh mMesh;
@@ -16,6 +19,12 @@ private:
   
   // RGB Buffer for frame conversion
   std::vector<uint8_t> mRgbaBuffer;
+
+  // Planar upload, converted to RGB in yuv.frag (CPU conversion is the fallback)
+  YuvTextures mYuv;
+  bool mGpuYuv = true;
+  std::vector<uint8_t> mNeutralChroma; // for decoders that only give Y
+  YuvConverter mConverter;
   
   // Video properties
   int mVideoWidth = 0;
@@ -58,19 +67,27 @@ public:
       return false;
     }
     
-    // Set up texture configuration
-    tex.filter(Texture::LINEAR);
-    tex.wrap(Texture::REPEAT, Texture::CLAMP_TO_EDGE, Texture::CLAMP_TO_EDGE);
-    tex.create2D(videoDecoder.width(), videoDecoder.height(), Texture::RGBA8,
-                 Texture::RGBA, Texture::UBYTE);
-
     // Set video playback parameters
     mVideoWidth = videoDecoder.width();
     mVideoHeight = videoDecoder.height();
     aspectRatio = mVideoWidth / (double)mVideoHeight;
-    
-    // Allocate an RGBA buffer for the converted frame
-    mRgbaBuffer.resize(mVideoWidth * mVideoHeight * 4);
+
+    // Upload the decoder's planes as they are, or fall back to converting on the CPU
+    if (mGpuYuv && !mYuv.create(mVideoWidth, mVideoHeight)) {
+      std::cerr << "VideoSphereLoader: falling back to CPU YUV conversion" << std::endl;
+      mGpuYuv = false;
+    }
+    if (mGpuYuv) {
+      mNeutralChroma.assign((mVideoWidth / 2) * (mVideoHeight / 2), 128);
+    } else {
+      // Set up texture configuration
+      tex.filter(Texture::LINEAR);
+      tex.wrap(Texture::REPEAT, Texture::CLAMP_TO_EDGE, Texture::CLAMP_TO_EDGE);
+      tex.create2D(mVideoWidth, mVideoHeight, Texture::RGBA8, Texture::RGBA, Texture::UBYTE);
+
+      // Allocate an RGBA buffer for the converted frame
+      mRgbaBuffer.resize(mVideoWidth * mVideoHeight * 4);
+    }
     
     // Start the video decoder thread
     videoDecoder.start();
@@ -89,11 +106,17 @@ public:
     MediaFrame* frame = videoDecoder.getVideoFrame(dt);
     
     if (frame) {
-      // Convert YUV to RGBA
-      convertYUVToRGBA(frame, mRgbaBuffer.data(), mVideoWidth, mVideoHeight);
-      
-      // Submit the converted RGBA data to the texture
-      tex.submit(mRgbaBuffer.data());
+      if (mGpuYuv) {
+        const bool hasChroma = !frame->dataU.empty() && !frame->dataV.empty();
+        mYuv.submit(frame->dataY.data(), hasChroma ? frame->dataU.data() : mNeutralChroma.data(),
+                    hasChroma ? frame->dataV.data() : mNeutralChroma.data());
+      } else {
+        // Convert YUV to RGBA
+        convertYUVToRGBA(frame, mRgbaBuffer.data(), mVideoWidth, mVideoHeight);
+
+        // Submit the converted RGBA data to the texture
+        tex.submit(mRgbaBuffer.data());
+      }
       
       // Tell the decoder we're done with this frame
       videoDecoder.gotVideoFrame();
@@ -103,6 +126,14 @@ public:
 
   void draw(Graphics& g) {
     g.pushMatrix();
+    if (mGpuYuv) {
+      mYuv.bind();
+      g.shader(mYuv.shader());
+      g.draw(mMesh);
+      mYuv.unbind();
+      g.popMatrix();
+      return;
+    }
     tex.bind(0);
     g.texture();
     g.draw(mMesh);
@@ -127,53 +158,36 @@ public:
   
   // Getters for video properties
   double getAspectRatio() const { return aspectRatio; }
+
+  // Before loadVideo(): false converts on the CPU and uploads RGBA instead
+  void setGpuYuv(bool gpu) { mGpuYuv = gpu; }
+
+  // Color matrix and range of the source, BT.601 full range by default
+  void setYuvFormat(const YuvFormat& format) {
+    mYuv.setFormat(format);
+    mConverter.setFormat(format);
+  }
   
   void cleanup() {
     videoDecoder.stop();
     videoDecoder.cleanup();
   }
   
-  // YUV to RGB conversion function
+  // YUV to RGB conversion function (CPU fallback, see yuvConvert.hpp)
   void convertYUVToRGBA(MediaFrame* frame, uint8_t* rgbaData, int width, int height) {
-    // Basic YUV to RGB conversion (BT.601 standard)
-    // This is a simple conversion - more sophisticated conversion would use proper color matrices
-    for (int i = 0; i < height; i++) {
-      for (int j = 0; j < width; j++) {
-        int index = i * width + j;
-        int rgbaIndex = index * 4;
-        
-        int y = frame->dataY[index];
-        
-        // If we have U and V data (some formats might only have Y)
-        int u = 128;  // Default to middle value if no U component
-        int v = 128;  // Default to middle value if no V component
-        
-        if (!frame->dataU.empty() && !frame->dataV.empty()) {
-          // U and V might be at lower resolution (usually half)
-          int uvIndex = (i / 2) * (width / 2) + (j / 2);
-          if (uvIndex < frame->dataU.size()) {
-            u = frame->dataU[uvIndex];
-            v = frame->dataV[uvIndex];
-          }
-        }
-        
-        // YUV to RGB conversion
-        int r = y + 1.402 * (v - 128);
-        int g = y - 0.344 * (u - 128) - 0.714 * (v - 128);
-        int b = y + 1.772 * (u - 128);
-        
-        // Clamp values to 0-255 range
-        r = (r < 0) ? 0 : ((r > 255) ? 255 : r);
-        g = (g < 0) ? 0 : ((g > 255) ? 255 : g);
-        b = (b < 0) ? 0 : ((b > 255) ? 255 : b);
-        
-        // Store RGBA values
-        rgbaData[rgbaIndex + 0] = r;     // R
-        rgbaData[rgbaIndex + 1] = g;     // G
-        rgbaData[rgbaIndex + 2] = b;     // B
-        rgbaData[rgbaIndex + 3] = 255;   // A (fully opaque)
-      }
+    // Some formats only have Y
+    const bool hasChroma = !frame->dataU.empty() && !frame->dataV.empty();
+    if (!hasChroma && mNeutralChroma.size() != size_t((width / 2) * (height / 2))) {
+      mNeutralChroma.assign((width / 2) * (height / 2), 128);
     }
+
+    YuvPlanes planes;
+    planes.y = frame->dataY.data();
+    planes.u = hasChroma ? frame->dataU.data() : mNeutralChroma.data();
+    planes.v = hasChroma ? frame->dataV.data() : mNeutralChroma.data();
+    planes.yStride = width;
+    planes.uvStride = width / 2;
+    mConverter.convert(planes, width, height, rgbaData, width * 4);
   }
 };
 
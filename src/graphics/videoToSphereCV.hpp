@@ -5,12 +5,21 @@
 #include "al_ext/opencv/al_OpenCV.hpp"
 #include "al/ui/al_ControlGUI.hpp"
 #include <vector>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <chrono>
+#include <cstring>
 #include <memory>
 #include <thread>
 #include <mutex>
 
+#include "framePack.hpp"
+#include "pboTextureStream.hpp"
+#include "segmentDecoder.hpp"
+#include "videoStream.hpp"
+#include "videoTiles.hpp"
+
 class VideoSphereLoaderCV : public al::PositionedVoice {
 private:
   al::Mesh mMesh;
@@ -24,7 +33,29 @@ private:
   // Async loading variables
   std::thread mLoadingThread;
   std::mutex mFramesMutex;
-  bool mIsLoading = false;
+  std::atomic<bool> mIsLoading { false };
+
+  // where frames come from, picked by loadVideo()
+  enum class VideoSource { Preload, Stream, Pack };
+  VideoSource mSource = VideoSource::Preload;
+
+  // streaming playback, see VideoStream; the alternative preloads every frame
+  bool mStreaming = true;
+  size_t mStreamBudget = VideoStream::kDefaultBudget;
+  VideoStream mStream;
+  int mShownFrame = -1; // last frame submitted to the texture while streaming or mapped
+
+  // baked frames next to the video, used in place of it when present, see FramePack
+  FramePack mPack;
+  static constexpr int kPackPrefetch = 8; // frames paged in ahead of the playhead
+
+  // frames reach the GPU through a PBO ring filled off the render thread, see PboTextureStream
+  bool mAsyncUpload = true;
+  PboTextureStream mUpload;
+
+  // the part of the sphere this node's projectors show; only those tiles are uploaded, see VideoTileGrid
+  std::vector<ViewFrustum> mRenderViews; // empty on nodes without an entry: whole frames
+  VideoTileGrid mTiles;
   
   // Video properties
   int mVideoWidth = 0;
@@ -68,6 +99,21 @@ public:
     std::cout << "Rotation speed set to: " << speed << std::endl;
   }
 
+  /**
+   * @brief Decode ahead of the playhead into at most `budgetBytes` (the
+   * default), or preload the whole file before playing. Short loops can
+   * preload; anything long should stream. Applies from the next video loaded.
+   */
+  void setStreaming(bool streaming, size_t budgetBytes = VideoStream::kDefaultBudget) {
+    mStreaming = streaming;
+    mStreamBudget = budgetBytes;
+  }
+
+  // false submits each frame to the texture on the render thread. Applies from the next video loaded.
+  void setAsyncUpload(bool async) {
+    mAsyncUpload = async;
+  }
+
   void setVideoFilePath(const std::string& videoFilePath) {
     mVideoFilePath.set(videoFilePath);
     // this->initFlag = true;
@@ -76,6 +122,29 @@ public:
 
   // Update the displayed frame based on the current frame index
   void updateDisplayFrame() {
+    if (mUpload.isOpen()) {
+      mUpload.request(mCurrentFrame); // the worker keeps trying until the frame is there
+      mShownFrame = mCurrentFrame;
+      if (mSource == VideoSource::Pack) { mPack.prefetch(mCurrentFrame + 1, kPackPrefetch); }
+      return;
+    }
+
+    if (mSource == VideoSource::Pack) {
+      mVideo.videoTexture.submit(mPack.frame(mCurrentFrame)); // straight from the page cache
+      mShownFrame = mCurrentFrame;
+      mPack.prefetch(mCurrentFrame + 1, kPackPrefetch);
+      return;
+    }
+
+    if (mSource == VideoSource::Stream) {
+      cv::Mat frame;
+      if (!mStream.acquire(mCurrentFrame, frame)) { return; } // not decoded yet, keep the last one up
+      mVideo.videoImage = frame;
+      mVideo.videoTexture.submit(mVideo.videoImage.ptr());
+      mShownFrame = mCurrentFrame;
+      return;
+    }
+
     std::lock_guard<std::mutex> lock(mFramesMutex);
     
     if (mFrames.empty()) {
@@ -143,6 +212,7 @@ public:
     }
 
     mGUI.registerParameterBundle(this->params());
+    mRenderViews = ViewFrustum::load("../assets/renderViews.txt", ViewFrustum::hostName());
     //this->loadVideo(); // moved to flag
   }
   
@@ -154,6 +224,16 @@ public:
     
     // Create a sphere mesh for rendering
     addTexSphere(mMesh, 15.0, 24, true);
+
+    // a baked pack skips decoding entirely, see src/tools/bakeFramePacks.cpp
+    const std::string packPath = FramePack::packPathFor(mVideoFilePath);
+    if (FramePack::exists(packPath)) {
+      if (!FramePack::upToDate(mVideoFilePath, packPath)) {
+        std::cerr << "Frame pack " << packPath << " is older than its video, decoding instead (re-run eoys_bake)" << std::endl;
+      } else if (mPack.open(packPath)) {
+        return loadPack(packPath);
+      }
+    }
     
     // Initialize the video file
     mVideo.initializeVideoCaptureFile(mVideoFilePath, true);
@@ -203,7 +283,23 @@ public:
     mVideo.videoImage = loadingFrame;
     mVideo.videoTexture.submit(mVideo.videoImage.ptr());
     
+    if (mStreaming) {
+      mSource = VideoSource::Stream;
+      // the stream has its own capture, this one was only needed to set up the texture
+      mVideo.cleanupVideoCapture();
+      if (!mStream.open(mVideoFilePath, mLooping, mStreamBudget)) {
+        return false;
+      }
+      mFrameCount = mStream.frameCount();
+      mShownFrame = -1;
+      std::cout << "  Streaming " << mStream.capacity() << " frames ahead" << std::endl;
+      openUpload(3);
+      mPlaying = true;
+      return true;
+    }
+
     // Start asynchronous loading
+    mSource = VideoSource::Preload;
     if (mLoadingThread.joinable()) {
       mLoadingThread.join();
     }
@@ -212,15 +308,99 @@ public:
     mLoadingThread = std::thread([this]() {
       this->loadFramesAsync();
     });
+    if (openUpload(3)) { updateDisplayFrame(); } // the placeholder, until the frames are in
     
     // Start playback
     mPlaying = true;
     
     return true;
   }
+
+  // frames come straight out of the mapped pack, no capture or placeholder needed
+  bool loadPack(const std::string& packPath) {
+    mSource = VideoSource::Pack;
+    mVideoWidth = mPack.width();
+    mVideoHeight = mPack.height();
+    mFrameRate = mPack.frameRate();
+    mFrameTime = 1.0 / mFrameRate;
+    mFrameCount = mPack.frameCount();
+    aspectRatio = mVideoWidth / (double)mVideoHeight;
+    std::cout << "  Mapped " << packPath << ": " << mVideoWidth << "x" << mVideoHeight << ", "
+              << mFrameCount << " frames at " << mFrameRate << " fps" << std::endl;
+
+    mVideo.videoTexture.filter(al::Texture::LINEAR);
+    mVideo.videoTexture.wrap(al::Texture::REPEAT, al::Texture::CLAMP_TO_EDGE, al::Texture::CLAMP_TO_EDGE);
+    const bool alpha = mPack.channels() == 4;
+    mVideo.videoTexture.create2D(mVideoWidth, mVideoHeight, alpha ? GL_RGBA8 : GL_RGB8,
+                                 alpha ? GL_BGRA : GL_BGR, GL_UNSIGNED_BYTE); // as OpenCV decodes
+
+    mCurrentFrame = 0;
+    mPack.prefetch(0, kPackPrefetch);
+    openUpload(mPack.channels());
+    updateDisplayFrame();
+    mPlaying = true;
+    return true;
+  }
+  
+  // starts the PBO ring for the current source, false leaves uploads on the render thread
+  bool openUpload(int channels) {
+    if (!mAsyncUpload) { return false; }
+    const bool opened = mUpload.open(mVideoWidth, mVideoHeight, channels,
+                                     [this](int index, uint8_t* dst, const std::vector<VideoTile>& regions) {
+      return this->fillFrame(index, dst, regions);
+    });
+    if (opened && !mRenderViews.empty()) { mTiles.configure(mVideoWidth, mVideoHeight); }
+    return opened;
+  }
+
+  // upload worker: copies `regions` of frame `index` from the current source into a mapped PBO
+  bool fillFrame(int index, uint8_t* dst, const std::vector<VideoTile>& regions) {
+    if (mSource == VideoSource::Pack) {
+      const uint8_t* src = mPack.frame(index); // only the visible tiles' bytes get paged in
+      const size_t pixel = size_t(mPack.channels());
+      const size_t srcStride = mPack.header().stride;
+      const size_t dstStride = size_t(mVideoWidth) * pixel; // the PBO's rows, as update() uploads them
+      for (const VideoTile& region : regions) {
+        for (int row = region.y; row < region.y + region.height; row++) {
+          std::memcpy(dst + row * dstStride + region.x * pixel, src + row * srcStride + region.x * pixel,
+                      region.width * pixel);
+        }
+      }
+      return true;
+    }
+    try {
+      if (mSource == VideoSource::Stream) {
+        cv::Mat frame;
+        return mStream.acquire(index, frame) && copyFrame(frame, dst, regions);
+      }
+      std::lock_guard<std::mutex> lock(mFramesMutex); // held by the worker now, not the render thread
+      if (mFrames.empty()) { return false; }
+      const int frameToShow = (!mIsLoading && mFrames.size() > 1 && index < int(mFrames.size())) ? index : 0;
+      return copyFrame(mFrames[frameToShow], dst, regions);
+    } catch (const cv::Exception& e) {
+      std::cerr << "OpenCV exception filling frame " << index << ": " << e.what() << std::endl;
+      return false;
+    }
+  }
+
+  // BGR into the PBO's rows, converting the BGRA placeholder
+  bool copyFrame(const cv::Mat& frame, uint8_t* dst, const std::vector<VideoTile>& regions) {
+    if (frame.empty() || frame.cols != mVideoWidth || frame.rows != mVideoHeight) { return false; }
+    cv::Mat target(mVideoHeight, mVideoWidth, CV_8UC3, dst); // wraps the mapped memory, no allocation
+    for (const VideoTile& region : regions) {
+      const cv::Rect rect(region.x, region.y, region.width, region.height);
+      cv::Mat targetRegion = target(rect);
+      if (frame.channels() == 4) {
+        cv::cvtColor(frame(rect), targetRegion, cv::COLOR_BGRA2BGR);
+      } else {
+        frame(rect).copyTo(targetRegion);
+      }
+    }
+    return true;
+  }
   
   void update(double dt) override {
-    if (mFrames.empty()) {
+    if (mSource != VideoSource::Pack && mFrames.empty()) {
       std::cerr << "No frames available in update" << std::endl;
       return;
     }
@@ -240,7 +420,13 @@ public:
       return;
     }
     
-    {
+    if (mSource == VideoSource::Pack) {
+      // every frame is already there
+    } else if (mSource == VideoSource::Stream) {
+      if (!mStream.ready()) return; // hold at the start until the first frames are decoded
+      mStream.setLooping(mLooping);
+      mFrameCount = mStream.frameCount(); // may shrink once the decoder finds the real end
+    } else {
       std::lock_guard<std::mutex> lock(mFramesMutex);
       if (mFrames.empty() || mFrames.size() <= 1) {
         // Still loading or no frames available
@@ -269,8 +455,8 @@ public:
       }
     }
     
-    // If we need to jump to a different frame
-    if (targetFrame != mCurrentFrame) {
+    // If we need to jump to a different frame, or a streamed one wasn't ready last time
+    if (targetFrame != mCurrentFrame || (mSource != VideoSource::Preload && mShownFrame != mCurrentFrame)) {
       mCurrentFrame = targetFrame;
       updateDisplayFrame();
     }
@@ -284,6 +470,13 @@ public:
       this->initFlag = false;
     }
 
+    // a renderer only uploads the tiles its projectors can see
+    if (!mRenderViews.empty() && mUpload.isOpen() &&
+        mTiles.update(mRenderViews, pose().quat(), rotate ? rotation.get() : 0.0)) {
+      mUpload.setRegions(mTiles.regions());
+    }
+    mUpload.update(); // swap in last frame's upload and start the next
+
     if (!mVideo.videoTexture.created()) {
       std::cerr << "Texture not created in draw" << std::endl;
       return;
@@ -301,10 +494,17 @@ public:
       }
     }    
 
-    mVideo.videoTexture.bind(0);
-    g.texture();
-    g.draw(mMesh);
-    mVideo.videoTexture.unbind(0);
+    if (mUpload.ready()) {
+      mUpload.bind(0);
+      g.texture();
+      g.draw(mMesh);
+      mUpload.unbind(0);
+    } else {
+      mVideo.videoTexture.bind(0);
+      g.texture();
+      g.draw(mMesh);
+      mVideo.videoTexture.unbind(0);
+    }
     g.popMatrix();
     if (!mIsReplica) {
       //mGUI.draw(g);
@@ -347,12 +547,18 @@ public:
   int getCurrentFrame() const { return mCurrentFrame; }
   
   void cleanup() {
+    // Stop the upload worker before the sources it reads from
+    mUpload.close();
+
     // Stop the loading thread
     mIsLoading = false;
     if (mLoadingThread.joinable()) {
       mLoadingThread.join();
     }
     
+    mStream.close();
+    mPack.close();
+
     // Clear all preloaded frames to free memory
     {
       std::lock_guard<std::mutex> lock(mFramesMutex);
@@ -363,42 +569,20 @@ public:
     mPlaying = false;
   }
   
-  // Asynchronous frame loading function
+  // Asynchronous frame loading function, decodes keyframe segments in parallel
   void loadFramesAsync() {
-    // Set to the beginning of the video
-    mVideo.videoCapture->set(cv::CAP_PROP_POS_FRAMES, 0);
-    
-    // Create a temporary vector to hold the frames
+    const std::string path = mVideoFilePath.get();
     std::vector<cv::Mat> tempFrames;
-    tempFrames.reserve(mFrameCount);
-    
-    // Read all frames
-    cv::Mat frame;
-    int frameCount = 0;
     
     try {
-      while (frameCount < mFrameCount && mVideo.videoCapture->isOpened() && mIsLoading) {
-        bool success = mVideo.videoCapture->read(frame);
-        if (!success || frame.empty()) {
-          std::cerr << "Warning: Failed to read frame " << frameCount << std::endl;
-          break;
-        }
-        
-        // Create a deep copy of the frame and store it
-        cv::Mat frameCopy = frame.clone();
-        if (frameCopy.empty()) {
-          std::cerr << "Warning: Failed to clone frame " << frameCount << std::endl;
-          break;
-        }
-        
-        tempFrames.push_back(frameCopy);
-        frameCount++;
-        
-        // Display progress
-        if (frameCount % 100 == 0 || frameCount == mFrameCount) {
-          std::cout << "  Loaded " << frameCount << " of " << mFrameCount << " frames" << std::endl;
-        }
-      }
+      int frameCount = mFrameCount;
+      std::vector<int> keyframes = SegmentDecoder::scanKeyframes(path, frameCount);
+      const unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+      // a few segments per worker so one slow segment doesn't hold up the rest
+      std::vector<VideoSegment> segments = SegmentDecoder::splitAtKeyframes(keyframes, frameCount, int(workers) * 2);
+      std::cout << "  Decoding " << frameCount << " frames in " << segments.size() << " segments ("
+                << keyframes.size() << " keyframes) on up to " << workers << " threads" << std::endl;
+      SegmentDecoder::decode(path, segments, tempFrames, mIsLoading, workers);
     } catch (const cv::Exception& e) {
       std::cerr << "OpenCV exception while loading frames: " << e.what() << std::endl;
     } catch (const std::exception& e) {
@@ -407,15 +591,24 @@ public:
       std::cerr << "Unknown exception while loading frames" << std::endl;
     }
     
+    // a segment that came up short leaves a hole, play up to the first one
+    auto hole = std::find_if(tempFrames.begin(), tempFrames.end(), [](const cv::Mat& frame) { return frame.empty(); });
+    if (hole != tempFrames.end()) {
+      if (mIsLoading) { std::cerr << "Warning: Failed to read frame " << (hole - tempFrames.begin()) << std::endl; }
+      tempFrames.erase(hole, tempFrames.end());
+    }
+    
     std::cout << "Loaded " << tempFrames.size() << " frames" << std::endl;
     
     // Replace the frames vector with our loaded frames
     {
       std::lock_guard<std::mutex> lock(mFramesMutex);
+      if (!tempFrames.empty()) { mFrameCount = int(tempFrames.size()); } // the container's count can be off
       mFrames = std::move(tempFrames);
     }
     
     mIsLoading = false;
+    mUpload.refresh(); // replace the placeholder even if the playhead hasn't moved
     
     // We can now close the video file since we have all frames in memory
     mVideo.cleanupVideoCapture();
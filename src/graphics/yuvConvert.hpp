@@ -0,0 +1,335 @@
+#ifndef EOYS_YUV_CONVERT_HPP
+#define EOYS_YUV_CONVERT_HPP
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define EOYS_YUV_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define EOYS_YUV_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+// eoys includes
+#include "yuvFormat.hpp"
+
+/**
+ * @brief One planar YUV 4:2:0 frame as the decoder hands it over. Chroma is
+ * half size in each direction.
+ */
+struct YuvPlanes {
+  const uint8_t* y = nullptr;
+  const uint8_t* u = nullptr;
+  const uint8_t* v = nullptr;
+  int yStride = 0; // bytes per row
+  int uvStride = 0;
+};
+
+/**
+ * @brief YUV 4:2:0 to RGBA on the CPU, for decoders and fallbacks that can't
+ * use YuvTextures.
+ *
+ * The coefficients come from YuvFormat in Q13 fixed point. Whole rows go
+ * through SSE2, or AVX2 where the CPU has it (8 or 16 pixels a step), with a
+ * scalar tail that does the same integer math. Frames of at least
+ * kParallelPixels are split into row bands: the caller converts the first and
+ * a pool of worker threads, started on the first such frame and kept until
+ * the converter goes away, converts the rest. Call convert() from one thread
+ * at a time.
+ */
+class YuvConverter {
+public:
+  static constexpr int kShift = 13;
+  static constexpr int kParallelPixels = 1280 * 720;
+
+  explicit YuvConverter(const YuvFormat& format = YuvFormat()) {
+    setFormat(format);
+    mThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  ~YuvConverter() {
+    stopWorkers();
+  }
+
+  YuvConverter(const YuvConverter&) = delete;
+  YuvConverter& operator=(const YuvConverter&) = delete;
+
+  void setFormat(const YuvFormat& format) {
+    float m[9], offset[3];
+    format.coefficients(m, offset);
+    auto q = [](float c) { return int16_t(std::lround(c * (1 << kShift))); };
+    mYOffset = int16_t(std::lround(offset[0] * 255.f));
+    mCy = q(m[0]);
+    mCrv = q(m[2]);
+    mCgu = q(m[4]);
+    mCgv = q(m[5]);
+    mCbu = q(m[7]);
+  }
+
+  // 1 converts on the calling thread only; a different count restarts the pool
+  void setThreads(unsigned threads) {
+    threads = std::max(1u, threads);
+    if (threads == mThreads) { return; }
+    stopWorkers();
+    mThreads = threads;
+  }
+
+  // the widest kernel this CPU runs: "avx2", "sse2" or "scalar"
+  static const char* isa() {
+    return hasAvx2() ? "avx2" : (sse2() ? "sse2" : "scalar");
+  }
+
+  // writes `height` rows of RGBA, `rgbaStride` bytes apart
+  void convert(const YuvPlanes& planes, int width, int height, uint8_t* rgba, int rgbaStride) {
+    const unsigned bands = int64_t(width) * height >= kParallelPixels ? std::min(mThreads, unsigned(height / 2)) : 1;
+    if (bands <= 1) {
+      convertRows(planes, width, 0, height, rgba, rgbaStride);
+      return;
+    }
+    if (mWorkers.empty()) { startWorkers(); }
+    const int rowsPerBand = ((height + int(bands) - 1) / int(bands) + 1) & ~1; // even, so bands share no chroma row
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mJob.planes = planes;
+      mJob.width = width;
+      mJob.height = height;
+      mJob.rgba = rgba;
+      mJob.rgbaStride = rgbaStride;
+      mJob.rowsPerBand = rowsPerBand;
+      mPending = (height - 1) / rowsPerBand; // bands after the caller's
+      mGeneration++;
+    }
+    mWake.notify_all();
+    convertRows(planes, width, 0, std::min(rowsPerBand, height), rgba, rgbaStride);
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDone.wait(lock, [this]() { return mPending == 0; });
+  }
+
+private:
+  struct Job {
+    YuvPlanes planes;
+    int width = 0, height = 0;
+    uint8_t* rgba = nullptr;
+    int rgbaStride = 0;
+    int rowsPerBand = 0;
+  };
+
+  int16_t mYOffset = 0, mCy = 0, mCrv = 0, mCgu = 0, mCgv = 0, mCbu = 0;
+  unsigned mThreads = 1;
+
+  std::vector<std::thread> mWorkers; // worker i converts band i + 1
+  std::mutex mMutex;
+  std::condition_variable mWake, mDone;
+  Job mJob; // guarded by mMutex
+  uint64_t mGeneration = 0; // bumped per job
+  int mPending = 0; // worker bands still converting
+  bool mStopping = false;
+
+  void startWorkers() {
+    mStopping = false;
+    const uint64_t generation = mGeneration; // before the job that starts them
+    for (unsigned band = 1; band < mThreads; band++) {
+      mWorkers.emplace_back([this, band, generation]() { work(int(band), generation); });
+    }
+  }
+
+  void stopWorkers() {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStopping = true;
+    }
+    mWake.notify_all();
+    for (auto& worker : mWorkers) { worker.join(); }
+    mWorkers.clear();
+  }
+
+  void work(int band, uint64_t seen) {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+      mWake.wait(lock, [&]() { return mStopping || mGeneration != seen; });
+      if (mStopping) { return; }
+      seen = mGeneration;
+      const Job job = mJob;
+      const int begin = band * job.rowsPerBand;
+      if (begin >= job.height) { continue; } // fewer bands than workers this frame
+      lock.unlock();
+      convertRows(job.planes, job.width, begin, std::min(begin + job.rowsPerBand, job.height), job.rgba, job.rgbaStride);
+      lock.lock();
+      if (--mPending == 0) { mDone.notify_one(); }
+    }
+  }
+
+  static bool sse2() {
+#if defined(EOYS_YUV_SSE2)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  static bool hasAvx2() {
+#if defined(EOYS_YUV_AVX2)
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+#else
+    return false;
+#endif
+  }
+
+  void convertRows(const YuvPlanes& planes, int width, int rowBegin, int rowEnd, uint8_t* rgba, int rgbaStride) const {
+#if defined(EOYS_YUV_AVX2)
+    const bool avx2 = hasAvx2();
+#endif
+    for (int row = rowBegin; row < rowEnd; row++) {
+      const uint8_t* y = planes.y + int64_t(row) * planes.yStride;
+      const uint8_t* u = planes.u + int64_t(row / 2) * planes.uvStride;
+      const uint8_t* v = planes.v + int64_t(row / 2) * planes.uvStride;
+      uint8_t* out = rgba + int64_t(row) * rgbaStride;
+      int x = 0;
+#if defined(EOYS_YUV_AVX2)
+      if (avx2) { x = rowAvx2(y, u, v, out, width); }
+#endif
+#if defined(EOYS_YUV_SSE2)
+      x += rowSse2(y + x, u + x / 2, v + x / 2, out + x * 4, width - x);
+#endif
+      rowScalar(y, u, v, out, x, width);
+    }
+  }
+
+  // pixels [x, width) one at a time, same fixed-point math as the kernels
+  void rowScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* out, int x, int width) const {
+    const int round = 1 << (kShift - 1);
+    const int lastChroma = std::max(0, width / 2 - 1); // odd widths reuse the last chroma sample
+    for (; x < width; x++) {
+      const int c = std::min(x / 2, lastChroma);
+      const int yy = mCy * (y[x] - mYOffset);
+      const int uu = u[c] - 128;
+      const int vv = v[c] - 128;
+      out[x * 4 + 0] = clamp((yy + mCrv * vv + round) >> kShift);
+      out[x * 4 + 1] = clamp((yy + mCgu * uu + mCgv * vv + round) >> kShift);
+      out[x * 4 + 2] = clamp((yy + mCbu * uu + round) >> kShift);
+      out[x * 4 + 3] = 255;
+    }
+  }
+
+  static uint8_t clamp(int value) {
+    return uint8_t(value < 0 ? 0 : (value > 255 ? 255 : value));
+  }
+
+#if defined(EOYS_YUV_SSE2)
+  // 8 pixels a step, returns how many pixels it did
+  int rowSse2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* out, int width) const {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i yOffset = _mm_set1_epi16(mYOffset);
+    const __m128i c128 = _mm_set1_epi16(128);
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i max = _mm_set1_epi16(255);
+    const __m128i alpha = _mm_set1_epi16(int16_t(0xFF00));
+    // (y, u) and (v, 1) pairs times (cy, cu) and (cv, round) with madd
+    const __m128i rYU = pairs(mCy, 0), rV1 = pairs(mCrv, 1 << (kShift - 1));
+    const __m128i gYU = pairs(mCy, mCgu), gV1 = pairs(mCgv, 1 << (kShift - 1));
+    const __m128i bYU = pairs(mCy, mCbu), bV1 = pairs(0, 1 << (kShift - 1));
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+      const __m128i yy = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x)), zero), yOffset);
+      __m128i uu = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(load4(u + x / 2)), zero), c128);
+      __m128i vv = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(load4(v + x / 2)), zero), c128);
+      uu = _mm_unpacklo_epi16(uu, uu); // one chroma sample per two pixels
+      vv = _mm_unpacklo_epi16(vv, vv);
+      const __m128i yuLo = _mm_unpacklo_epi16(yy, uu), yuHi = _mm_unpackhi_epi16(yy, uu);
+      const __m128i v1Lo = _mm_unpacklo_epi16(vv, ones), v1Hi = _mm_unpackhi_epi16(vv, ones);
+
+      auto channel = [&](__m128i cYU, __m128i cV1) {
+        const __m128i lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuLo, cYU), _mm_madd_epi16(v1Lo, cV1)), kShift);
+        const __m128i hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuHi, cYU), _mm_madd_epi16(v1Hi, cV1)), kShift);
+        return _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(lo, hi), zero), max);
+      };
+      const __m128i r = channel(rYU, rV1), g = channel(gYU, gV1), b = channel(bYU, bV1);
+      const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+      const __m128i ba = _mm_or_si128(b, alpha);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_unpacklo_epi16(rg, ba));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4 + 16), _mm_unpackhi_epi16(rg, ba));
+    }
+    return x;
+  }
+
+  static __m128i pairs(int16_t even, int16_t odd) {
+    return _mm_set1_epi32(int32_t(uint16_t(even)) | (int32_t(odd) << 16));
+  }
+
+  static int load4(const uint8_t* p) {
+    int value;
+    std::memcpy(&value, p, 4);
+    return value;
+  }
+#endif
+
+#if defined(EOYS_YUV_AVX2)
+  // 16 pixels a step, same math as rowSse2 with the lanes kept in order
+  __attribute__((target("avx2"))) int rowAvx2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* out,
+                                              int width) const {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i yOffset = _mm256_set1_epi16(mYOffset);
+    const __m256i c128 = _mm256_set1_epi16(128);
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m256i max = _mm256_set1_epi16(255);
+    const __m256i alpha = _mm256_set1_epi16(int16_t(0xFF00));
+    const __m256i rYU = pairs256(mCy, 0), rV1 = pairs256(mCrv, 1 << (kShift - 1));
+    const __m256i gYU = pairs256(mCy, mCgu), gV1 = pairs256(mCgv, 1 << (kShift - 1));
+    const __m256i bYU = pairs256(mCy, mCbu), bV1 = pairs256(0, 1 << (kShift - 1));
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+      const __m256i yy = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x))), yOffset);
+      const __m128i u8 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2)), _mm_setzero_si128());
+      const __m128i v8 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2)), _mm_setzero_si128());
+      // duplicate each chroma sample, pixels 0-7 in the low lane and 8-15 in the high
+      const __m256i uu = _mm256_sub_epi16(combine(_mm_unpacklo_epi16(u8, u8), _mm_unpackhi_epi16(u8, u8)), c128);
+      const __m256i vv = _mm256_sub_epi16(combine(_mm_unpacklo_epi16(v8, v8), _mm_unpackhi_epi16(v8, v8)), c128);
+      // unpack works per lane: lo holds pixels 0-3 and 8-11, hi holds 4-7 and 12-15
+      const __m256i yuLo = _mm256_unpacklo_epi16(yy, uu), yuHi = _mm256_unpackhi_epi16(yy, uu);
+      const __m256i v1Lo = _mm256_unpacklo_epi16(vv, ones), v1Hi = _mm256_unpackhi_epi16(vv, ones);
+
+      // packs undoes the lane split, so channels come back in pixel order
+      const __m256i r = channel256(yuLo, yuHi, v1Lo, v1Hi, rYU, rV1, zero, max);
+      const __m256i g = channel256(yuLo, yuHi, v1Lo, v1Hi, gYU, gV1, zero, max);
+      const __m256i b = channel256(yuLo, yuHi, v1Lo, v1Hi, bYU, bV1, zero, max);
+      const __m256i rg = _mm256_or_si256(r, _mm256_slli_epi16(g, 8));
+      const __m256i ba = _mm256_or_si256(b, alpha);
+      const __m256i lo = _mm256_unpacklo_epi16(rg, ba), hi = _mm256_unpackhi_epi16(rg, ba);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 4), _mm256_permute2x128_si256(lo, hi, 0x20));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 4 + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    return x;
+  }
+
+  // helpers are their own avx2 functions: lambdas don't inherit the target
+  __attribute__((target("avx2"))) static __m256i channel256(__m256i yuLo, __m256i yuHi, __m256i v1Lo, __m256i v1Hi,
+                                                            __m256i cYU, __m256i cV1, __m256i zero, __m256i max) {
+    const __m256i lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuLo, cYU), _mm256_madd_epi16(v1Lo, cV1)), kShift);
+    const __m256i hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuHi, cYU), _mm256_madd_epi16(v1Hi, cV1)), kShift);
+    return _mm256_min_epi16(_mm256_max_epi16(_mm256_packs_epi32(lo, hi), zero), max);
+  }
+
+  __attribute__((target("avx2"))) static __m256i pairs256(int16_t even, int16_t odd) {
+    return _mm256_set1_epi32(int32_t(uint16_t(even)) | (int32_t(odd) << 16));
+  }
+
+  __attribute__((target("avx2"))) static __m256i combine(__m128i low, __m128i high) {
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+  }
+#endif
+};
+
+#endif // EOYS_YUV_CONVERT_HPP
@@ -0,0 +1,35 @@
+#ifndef EOYS_YUV_FORMAT_HPP
+#define EOYS_YUV_FORMAT_HPP
+
+/**
+ * @brief How a decoder's Y'CbCr maps to RGB: which matrix and which range.
+ * One place for the coefficients, so the GPU (YuvTextures) and CPU
+ * conversions agree.
+ */
+struct YuvFormat {
+  enum class Matrix { BT601, BT709 };
+
+  Matrix matrix = Matrix::BT601;
+  bool fullRange = true; // false: Y in 16..235, chroma in 16..240
+
+  /**
+   * @brief `rgb = m * (yuv - offset)` with every channel normalized to 0..1.
+   * `m` is row-major (m[0..2] make R). Range scaling is folded in.
+   */
+  void coefficients(float m[9], float offset[3]) const {
+    const float kr = matrix == Matrix::BT709 ? 0.2126f : 0.299f;
+    const float kb = matrix == Matrix::BT709 ? 0.0722f : 0.114f;
+    const float kg = 1.f - kr - kb;
+    const float yScale = fullRange ? 1.f : 255.f / 219.f;
+    const float cScale = fullRange ? 1.f : 255.f / 224.f;
+    offset[0] = fullRange ? 0.f : 16.f / 255.f;
+    offset[1] = 128.f / 255.f;
+    offset[2] = 128.f / 255.f;
+
+    m[0] = yScale; m[1] = 0.f;                                m[2] = cScale * 2.f * (1.f - kr);
+    m[3] = yScale; m[4] = -cScale * 2.f * (1.f - kb) * kb / kg; m[5] = -cScale * 2.f * (1.f - kr) * kr / kg;
+    m[6] = yScale; m[7] = cScale * 2.f * (1.f - kb);          m[8] = 0.f;
+  }
+};
+
+#endif // EOYS_YUV_FORMAT_HPP
@@ -0,0 +1,114 @@
+#ifndef EOYS_YUV_TEXTURES_HPP
+#define EOYS_YUV_TEXTURES_HPP
+
+// std includes
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// al includes
+#include "al/graphics/al_OpenGL.hpp"
+#include "al/graphics/al_Shader.hpp"
+#include "al/graphics/al_Texture.hpp"
+
+// eoys includes
+#include "yuvFormat.hpp"
+
+/**
+ * @brief A planar YUV 4:2:0 frame as three one-channel textures, converted to
+ * RGB in a fragment shader (src/shaders/yuv.frag) instead of on the CPU.
+ *
+ * An upload is 1.5 bytes per pixel instead of RGBA's 4. The chroma planes are
+ * half size in each direction, as the decoder hands them over.
+ *
+ * Call create() and the rest on the graphics thread. To draw, call bind(),
+ * then `g.shader(shader())` and draw a textured mesh, then unbind().
+ */
+class YuvTextures {
+public:
+  static constexpr int kYUnit = 0;
+  static constexpr int kUUnit = 1;
+  static constexpr int kVUnit = 2;
+
+  // sizes the planes and loads the shader, returns false if it doesn't compile
+  bool create(int width, int height) {
+    mWidth = width;
+    mHeight = height;
+    mY.create2D(width, height, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+    mU.create2D(width / 2, height / 2, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+    mV.create2D(width / 2, height / 2, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+    for (al::Texture* tex : { &mY, &mU, &mV }) {
+      tex->filter(GL_LINEAR);
+      tex->wrap(GL_REPEAT, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE); // wraps around the sphere's seam
+    }
+    if (mShaderLoaded) { return true; }
+    mShaderLoaded = mShader.compile(loadFile("../src/shaders/yuv.vert"), loadFile("../src/shaders/yuv.frag"));
+    if (!mShaderLoaded) {
+      std::cerr << "YuvTextures Error: yuv shader failed to compile" << std::endl;
+      mShader.printLog();
+    }
+    return mShaderLoaded;
+  }
+
+  void setFormat(const YuvFormat& format) {
+    mFormat = format;
+  }
+
+  // tightly packed planes: Y is width x height, U and V are half that each way
+  void submit(const uint8_t* y, const uint8_t* u, const uint8_t* v) {
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // plane widths needn't be multiples of 4
+    mY.submit(y);
+    mU.submit(u);
+    mV.submit(v);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  }
+
+  // binds the planes and sets the conversion uniforms
+  void bind() {
+    mY.bind(kYUnit);
+    mU.bind(kUUnit);
+    mV.bind(kVUnit);
+    float m[9], offset[3];
+    mFormat.coefficients(m, offset);
+    mShader.use();
+    mShader.uniform("u_y", kYUnit);
+    mShader.uniform("u_u", kUUnit);
+    mShader.uniform("u_v", kVUnit);
+    mShader.uniform("u_offset", offset[0], offset[1], offset[2]);
+    mShader.uniformMatrix3(mShader.getUniformLocation("u_matrix"), m, true); // row-major
+  }
+
+  void unbind() {
+    mY.unbind(kYUnit);
+    mU.unbind(kUUnit);
+    mV.unbind(kVUnit);
+  }
+
+  al::ShaderProgram& shader() {
+    return mShader;
+  }
+
+  int width() const { return mWidth; }
+  int height() const { return mHeight; }
+
+private:
+  al::Texture mY, mU, mV;
+  al::ShaderProgram mShader;
+  bool mShaderLoaded = false;
+  YuvFormat mFormat;
+  int mWidth = 0, mHeight = 0;
+
+  static std::string loadFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+      std::cerr << "YuvTextures Error: Cannot open " << path << std::endl;
+      return "";
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+  }
+};
+
+#endif // EOYS_YUV_TEXTURES_HPP
@@ -11,10 +11,15 @@
   // Allosphere configuration
   #define SAMPLE_RATE 44100
   #define AUDIO_CONFIG SAMPLE_RATE, 256, 60, 9
-  #define SPATIALIZER_TYPE al::Dbap
+  #define SPATIALIZER_TYPE CachedDbap // al::Dbap with per-agent gain caching
+  // #define SPATIALIZER_TYPE HoaSpatializer<5> // shared 5th order ambisonic bus, AllRAD decode
   #define SPEAKER_LAYOUT al::AlloSphereSpeakerLayoutCompensated()
 #endif
 
+#define VOICE_POOL_DEPTH 2 // voices of each visual type built at startup
+#define GUITAR_AMP_MODEL "../assets/namModels/MarshallModel.nam"
+#define BASS_AMP_MODEL "../assets/namModels/BassModel.nam"
+
 
 #include "al/app/al_DistributedApp.hpp"
 #include "src/graphics/videoToSphereCV.hpp"
@@ -27,11 +32,10 @@
 #include "al/sound/al_Spatializer.hpp"
 #include "al/sound/al_Ambisonics.hpp"
 #include "al/sound/al_Dbap.hpp"
+#include "src/audio/cachedDbap.hpp"
+#include "src/audio/hoaSpatializer.hpp"
 #include "al/sphere/al_AlloSphereSpeakerLayout.hpp"
 
-#include "../assets/namModels/BassModel.h"
-#include "../assets/namModels/MarshallModel.h"
-
 // Gamma ig for now
 #include "Gamma/SamplePlayer.h"
 
@@ -66,7 +70,7 @@ public:
       videoVoice->resetRotation();
     }
 
-    auto* voice = mManager.scene()->getVoice<TSynthVoice>();
+    auto* voice = mManager.getVoice<TSynthVoice>();
     if (offset) {
       voice->setPose(al::Pose(al::Vec3d(0, 31, 0)));
     }
@@ -336,6 +340,13 @@ public:
     mManager.scene()->registerSynthClass<ShaderEngine>();
     mManager.scene()->registerSynthClass<VideoSphereLoaderCV>();
 
+    // build voices now rather than mid-show, cues alternate so keep a spare
+    mManager.prewarmVoices<ImageSphereLoader>(VOICE_POOL_DEPTH);
+    mManager.prewarmVoices<AssetEngine>(VOICE_POOL_DEPTH);
+    mManager.prewarmVoices<ShaderEngine>(VOICE_POOL_DEPTH);
+    mManager.prewarmVoices<VideoSphereLoaderCV>(VOICE_POOL_DEPTH);
+    mManager.reportVoicePools();
+
     player[0].load("../assets/wavFiles/vocals.wav");
     player[1].load("../assets/wavFiles/guitar.wav");
     player[2].load("../assets/wavFiles/bass.wav");
@@ -389,7 +400,9 @@ public:
 
     // gtr fx
     for (auto i = 1; i < 4; i++) {
-      mManager.agents()->at(i)->addAmp<float, MarshallModelLayer1, MarshallModelLayer2, MarshallModelWeights>();
+      if (!mManager.agents()->at(i)->addAmp(GUITAR_AMP_MODEL)) {
+        std::cerr << "Main Error: guitar amp " << i << " has no model, check assets/namModels" << std::endl;
+      }
       mManager.agents()->at(i)->addEffect<giml::Detune<float>, SAMPLE_RATE>();
       mManager.agents()->at(i)->addEffect<giml::Delay<float>, SAMPLE_RATE>();
       mManager.agents()->at(i)->addEffect<giml::Reverb<float>, SAMPLE_RATE>();
@@ -397,7 +410,9 @@ public:
     }
 
     // bass fx
-    mManager.agents()->at(4)->addAmp<float, BassModelLayer1, BassModelLayer2, BassModelWeights>();
+    if (!mManager.agents()->at(4)->addAmp(BASS_AMP_MODEL)) {
+      std::cerr << "Main Error: bass amp has no model, check assets/namModels" << std::endl;
+    }
     mManager.agents()->at(4)->addEffect<giml::Compressor<float>, SAMPLE_RATE>();
     mManager.agents()->at(4)->updateParameters();
 
@@ -419,6 +434,19 @@ public:
 
     // prepare audio engine
     mManager.prepare(audioIO());
+    if (isPrimary()) {
+      mManager.analysis().start(); // only the primary feeds it audio
+      mManager.analysis().trackBeats(3); // kick
+      mManager.analysis().trackPitch(0); // vocals
+      mManager.analysis().trackPitch(1); // guitar
+
+      // drum mics, same inputs as their agents; toms get more kick bleed
+      mManager.drums().addDrum(names[5], 3, 0.10f, 60.f);
+      mManager.drums().addDrum(names[6], 4, 0.08f, 40.f); // rolls
+      for (unsigned i = 7; i < 10; i++) {
+        mManager.drums().addDrum(names[i], i - 2, 0.15f, 70.f);
+      }
+    }
 
     // Set camera position and orientation
     if (isPrimary()) {
@@ -516,10 +544,18 @@ public:
       else if (k.key() == 'm') { mMute = !mMute; }
       else if (k.key() == 'g') { mAudioMode = !mAudioMode; }
       else if (k.key() == 's') { mManager.storePresets(); }
+      else if (k.key() == 'p') { mManager.reportVoicePools(); }
+      else if (k.key() == 'r') { reloadAmps(); }
     }
     return true;
   }
 
+  // re-reads the amp models from disk and crossfades to them, e.g. after replacing a .nam file
+  void reloadAmps() {
+    for (auto i = 1; i < 4; i++) { mManager.agents()->at(i)->loadAmp(GUITAR_AMP_MODEL); }
+    mManager.agents()->at(4)->loadAmp(BASS_AMP_MODEL);
+  }
+
   void onDraw(al::Graphics& g) override {
     g.lens().eyeSep(0.0); // disable stereo rendering
     g.clear(0);
@@ -552,6 +588,10 @@ public:
     mManager.onMouseUp(graphics(), m, width(), height());
     return true;
   }
+
+  void onExit() override {
+    if (isPrimary()) { mManager.reportVoicePools(); } // any misses mean the pools need to be deeper
+  }
 };
 
 int main() {
@@ -9,6 +9,12 @@ uniform float u_time;
 uniform float onset;
 uniform float cent;
 uniform float flux;
+uniform float beatPhase; // 0 on the beat .. 1
+uniform float bpm;
+uniform float kick; // last hit's velocity, decaying
+uniform float snare;
+uniform sampler2D u_spectrum; // log-frequency, 0..1
+uniform sampler2D u_waveform; // 0.5 = silence
 
 
 // *** STARTER CODE INSPIRED BY : https://www.shadertoy.com/view/4lSSRy *** //
@@ -23,7 +29,7 @@ void main() {
     //t +=cent;
     float k = cos(t);
     float l = sin(t);
-    float s = 0.2+(onset/10.0); //+ (onset / u_time);
+    float s = 0.2+(onset/10.0) + 0.02*kick; //+ (onset / u_time);
 
     // for(int i=0; i<64; ++i) {
         // uv  = abs(uv) - s*flux;//-onset;    // Mirror
@@ -45,6 +51,9 @@ void main() {
      //fragColor =  x* vec4(1,2*flux,3,1);
     //fragColor = vec4(vec3(x), 1);
     fragColor = .5 + .5*cos(6.28318*(40.0*length(uv))*vec4(-1,2+(u_time/500.0),3+flux,1)); //u time makes it grainy over time
+    fragColor.rgb *= 0.85 + 0.15 * pow(1.0 - beatPhase, 4.0); // pulse on the beat
+    fragColor.rgb += 0.2 * snare; // flash on the snare
+    fragColor.rgb += 0.15 * texture(u_spectrum, vec2(clamp(length(vPos.xy) / 15.0, 0.0, 1.0), 0.5)).r; // bass at the centre
 
 }
  
\ No newline at end of file
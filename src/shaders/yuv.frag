@@ -0,0 +1,16 @@
+#version 330 core
+
+// planar YUV 4:2:0 -> RGB, see src/graphics/yuvTextures.hpp
+uniform sampler2D u_y;
+uniform sampler2D u_u; // half size
+uniform sampler2D u_v; // half size
+uniform mat3 u_matrix; // BT.601 / BT.709, range folded in
+uniform vec3 u_offset;
+
+in vec2 vUV;
+out vec4 fragColor;
+
+void main() {
+    vec3 yuv = vec3(texture(u_y, vUV).r, texture(u_u, vUV).r, texture(u_v, vUV).r);
+    fragColor = vec4(clamp(u_matrix * (yuv - u_offset), 0.0, 1.0), 1.0);
+}
@@ -0,0 +1,20 @@
+// Benchmark-and-accuracy mode for the amp model kernels.
+// Runs every ISA backend available on this machine (see namDispatch.hpp)
+// over a guitar DI and prints ns/sample and ESR against the builtin kernels.
+// The eoys_nam_<isa>.so modules are found next to the executable (bin/).
+//   eoys_amp_benchmark <model.nam> <di.wav>
+//   eoys_amp_benchmark <model.nam> --synthetic   (decaying plucks, no recording)
+
+#include <cstring>
+
+#include "../../audio/namDispatch.hpp"
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "usage: " << argv[0] << " <model.nam> <di.wav | --synthetic>" << std::endl;
+    return 1;
+  }
+  const std::string diPath = std::strcmp(argv[2], "--synthetic") == 0 ? "" : argv[2];
+  benchmarkNamBackends(argv[1], diPath);
+  return 0;
+}
@@ -0,0 +1,61 @@
+// Microbenchmark for the per-hop feature extractor (see featureExtractor.hpp).
+// Times FeatureExtractor::process() on a 1024-point FFT (513 bins), the size
+// SpectralListener uses, against the old separate getCent() + getFlux() walks.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "../../graphics/featureExtractor.hpp"
+
+int main(int argc, char* argv[]) {
+  const int numBins = 513; // 1024-point STFT
+  const float binFreq = 44100.f / 1024.f;
+  const int hops = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+  // a few spectra to cycle through so flux isn't always zero
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> dist(0.f, 1.f);
+  std::vector<std::vector<float>> spectra(4, std::vector<float>(numBins));
+  for (auto& spectrum : spectra) {
+    for (auto& bin : spectrum) { bin = dist(rng); }
+  }
+
+  FeatureExtractor extractor;
+  extractor.configure(numBins, binFreq);
+  FeatureFrame frame;
+  float sink = 0.f; // keeps the optimizer honest
+
+  auto start = std::chrono::steady_clock::now();
+  for (int hop = 0; hop < hops; hop++) {
+    extractor.process(spectra[hop & 3].data(), frame);
+    sink += frame.centroid + frame.flux + frame.flatness;
+  }
+  double extractorNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / hops;
+
+  // reference: what SpectralListener::getCent() and getFlux() did, two walks and a copy
+  std::vector<float> prev(numBins, 0.f);
+  start = std::chrono::steady_clock::now();
+  for (int hop = 0; hop < hops; hop++) {
+    const std::vector<float>& mags = spectra[hop & 3];
+    float weightedSum = 0.f, magSum = 0.f, flux = 0.f;
+    for (int i = 0; i < numBins; i++) {
+      weightedSum += i * binFreq * mags[i];
+      magSum += mags[i];
+    }
+    for (int i = 0; i < numBins; i++) {
+      flux += std::max(mags[i] - prev[i], 0.f);
+    }
+    prev = mags;
+    sink += weightedSum / magSum + flux;
+  }
+  double referenceNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / hops;
+
+  std::printf("FeatureExtractor (all features): %8.1f ns/hop\n", extractorNs);
+  std::printf("getCent + getFlux (2 features):  %8.1f ns/hop\n", referenceNs);
+  std::printf("hop budget at 256 samples / 44.1kHz: %.0f ns (%.3f%% used)\n",
+              256e9 / 44100.0, 100.0 * extractorNs / (256e9 / 44100.0));
+  std::printf("(%g)\n", sink);
+  return 0;
+}
@@ -0,0 +1,97 @@
+// Benchmark for the CPU YUV 4:2:0 -> RGBA conversion (see yuvConvert.hpp).
+// Times YuvConverter on one thread and on all of them against the per-pixel
+// float loop VideoSphereLoader::convertYUVToRGBA used, and reports the largest
+// difference from it (the old loop truncates, so 1 is expected).
+//   eoys_yuv_benchmark [frames]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../../graphics/yuvConvert.hpp"
+
+// what VideoSphereLoader::convertYUVToRGBA did
+static void referenceConvert(const std::vector<uint8_t>& dataY, const std::vector<uint8_t>& dataU,
+                             const std::vector<uint8_t>& dataV, uint8_t* rgbaData, int width, int height) {
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      int index = i * width + j;
+      int rgbaIndex = index * 4;
+      int y = dataY[index];
+      int u = 128;
+      int v = 128;
+      if (!dataU.empty() && !dataV.empty()) {
+        int uvIndex = (i / 2) * (width / 2) + (j / 2);
+        if (size_t(uvIndex) < dataU.size()) {
+          u = dataU[uvIndex];
+          v = dataV[uvIndex];
+        }
+      }
+      int r = y + 1.402 * (v - 128);
+      int g = y - 0.344 * (u - 128) - 0.714 * (v - 128);
+      int b = y + 1.772 * (u - 128);
+      r = (r < 0) ? 0 : ((r > 255) ? 255 : r);
+      g = (g < 0) ? 0 : ((g > 255) ? 255 : g);
+      b = (b < 0) ? 0 : ((b > 255) ? 255 : b);
+      rgbaData[rgbaIndex + 0] = r;
+      rgbaData[rgbaIndex + 1] = g;
+      rgbaData[rgbaIndex + 2] = b;
+      rgbaData[rgbaIndex + 3] = 255;
+    }
+  }
+}
+
+template <typename F>
+static double megapixelsPerSecond(int width, int height, int frames, F&& convert) {
+  convert(); // warm up caches and threads
+  auto start = std::chrono::steady_clock::now();
+  for (int f = 0; f < frames; f++) { convert(); }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return double(width) * height * frames / seconds / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+  const int frames = argc > 1 ? std::atoi(argv[1]) : 30;
+  const int sizes[][2] = { { 1920, 1080 }, { 3840, 1920 }, { 5760, 2880 } };
+
+  std::printf("YuvConverter: %s kernel, %u threads\n", YuvConverter::isa(), std::max(1u, std::thread::hardware_concurrency()));
+  std::printf("%12s %14s %14s %14s %9s\n", "frame", "reference", "1 thread", "all threads", "max diff");
+  std::mt19937 rng(1);
+  for (const auto& size : sizes) {
+    const int width = size[0], height = size[1];
+    std::vector<uint8_t> dataY(width * height), dataU((width / 2) * (height / 2)), dataV(dataU.size());
+    for (auto& b : dataY) { b = uint8_t(rng()); }
+    for (auto& b : dataU) { b = uint8_t(rng()); }
+    for (auto& b : dataV) { b = uint8_t(rng()); }
+    YuvPlanes planes;
+    planes.y = dataY.data();
+    planes.u = dataU.data();
+    planes.v = dataV.data();
+    planes.yStride = width;
+    planes.uvStride = width / 2;
+
+    std::vector<uint8_t> reference(width * height * 4), converted(reference.size());
+    YuvConverter converter; // BT.601 full range, like the reference
+    const double referenceRate = megapixelsPerSecond(width, height, frames, [&]() {
+      referenceConvert(dataY, dataU, dataV, reference.data(), width, height);
+    });
+    converter.setThreads(1);
+    const double singleRate = megapixelsPerSecond(width, height, frames, [&]() {
+      converter.convert(planes, width, height, converted.data(), width * 4);
+    });
+    converter.setThreads(std::thread::hardware_concurrency());
+    const double threadedRate = megapixelsPerSecond(width, height, frames, [&]() {
+      converter.convert(planes, width, height, converted.data(), width * 4);
+    });
+
+    int maxDiff = 0;
+    for (size_t i = 0; i < reference.size(); i++) { maxDiff = std::max(maxDiff, std::abs(int(reference[i]) - int(converted[i]))); }
+    char label[32];
+    std::snprintf(label, sizeof(label), "%dx%d", width, height);
+    std::printf("%12s %9.1f MP/s %9.1f MP/s %9.1f MP/s %9d\n", label, referenceRate, singleRate, threadedRate, maxDiff);
+  }
+  return 0;
+}
@@ -0,0 +1,131 @@
+// Bakes show videos into frame packs (see src/graphics/framePack.hpp) so
+// renderers map decoded frames instead of decoding H.264 at every cue.
+//
+//   eoys_bake [--force] <video or directory>...
+//
+// Each video gets a .pack next to it, which VideoSphereLoaderCV picks up in
+// place of the video. Directories are searched recursively for .mp4/.mov/.m4v.
+// Packs newer than their video are skipped unless --force is given.
+
+// std includes
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+// opencv includes
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+// eoys includes
+#include "../graphics/framePack.hpp"
+
+static bool isVideo(const std::string& path) {
+  std::string lower = path;
+  std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+  for (const char* extension : { ".mp4", ".mov", ".m4v" }) {
+    const std::string ext(extension);
+    if (lower.size() > ext.size() && lower.compare(lower.size() - ext.size(), ext.size(), ext) == 0) { return true; }
+  }
+  return false;
+}
+
+static void collect(const std::string& path, std::vector<std::string>& videos) {
+  struct stat info;
+  if (stat(path.c_str(), &info) != 0) {
+    std::cerr << "eoys_bake: No such file " << path << std::endl;
+    return;
+  }
+  if (!S_ISDIR(info.st_mode)) {
+    videos.push_back(path);
+    return;
+  }
+  DIR* dir = opendir(path.c_str());
+  if (!dir) { return; }
+  std::vector<std::string> children;
+  while (dirent* entry = readdir(dir)) {
+    const std::string name = entry->d_name;
+    if (name == "." || name == "..") { continue; }
+    children.push_back(path + "/" + name);
+  }
+  closedir(dir);
+  std::sort(children.begin(), children.end());
+  for (const auto& child : children) {
+    struct stat childInfo;
+    if (stat(child.c_str(), &childInfo) != 0) { continue; }
+    if (S_ISDIR(childInfo.st_mode)) { collect(child, videos); }
+    else if (isVideo(child)) { videos.push_back(child); }
+  }
+}
+
+static bool bake(const std::string& video, const std::string& pack) {
+  cv::VideoCapture capture(video);
+  if (!capture.isOpened()) {
+    std::cerr << "eoys_bake: Could not open " << video << std::endl;
+    return false;
+  }
+  const double frameRate = capture.get(cv::CAP_PROP_FPS);
+  const int expected = int(capture.get(cv::CAP_PROP_FRAME_COUNT));
+  const auto start = std::chrono::steady_clock::now();
+
+  FramePackWriter writer;
+  cv::Mat frame;
+  int width = 0, height = 0, channels = 0;
+  while (capture.read(frame) && !frame.empty()) {
+    const bool sameSize = writer.framesWritten() == 0 || (frame.cols == width && frame.rows == height && frame.channels() == channels);
+    if (frame.depth() != CV_8U || (frame.channels() != 3 && frame.channels() != 4) || !sameSize) {
+      std::cerr << "eoys_bake: Unsupported frame format in " << video << std::endl;
+      return false;
+    }
+    if (writer.framesWritten() == 0) {
+      width = frame.cols;
+      height = frame.rows;
+      channels = frame.channels();
+      if (!writer.open(pack, width, height, channels, frameRate > 0.0 ? frameRate : 30.0)) { return false; }
+    }
+    if (!writer.write(frame.ptr(), frame.step)) { return false; }
+    if (writer.framesWritten() % 100 == 0) {
+      std::cout << "  " << writer.framesWritten() << " of " << expected << " frames" << std::endl;
+    }
+  }
+  if (writer.framesWritten() == 0) {
+    std::cerr << "eoys_bake: No frames decoded from " << video << std::endl;
+    return false;
+  }
+  if (!writer.finish()) { return false; }
+
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "  " << writer.framesWritten() << " frames, " << width << "x" << height
+            << ", " << seconds << "s -> " << pack << std::endl;
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  bool force = false;
+  std::vector<std::string> videos;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--force") { force = true; }
+    else { collect(arg, videos); }
+  }
+  if (videos.empty()) {
+    std::cerr << "usage: eoys_bake [--force] <video or directory>..." << std::endl;
+    return 1;
+  }
+
+  int failed = 0;
+  for (const auto& video : videos) {
+    const std::string pack = FramePack::packPathFor(video);
+    if (!force && FramePack::upToDate(video, pack)) {
+      std::cout << "Up to date: " << pack << std::endl;
+      continue;
+    }
+    std::cout << "Baking " << video << std::endl;
+    if (!bake(video, pack)) { failed++; }
+  }
+  return failed == 0 ? 0 : 1;
+}